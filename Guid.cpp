@@ -19,67 +19,118 @@
 
 #include "Guid.h"
 
+#include <QAbstractButton>
+#include <QAbstractScrollArea>
+#include <QAbstractTableModel>
 #include <QAction>
+#include <QAtomicInt>
+#include <QAtomicPointer>
+#include <QBitArray>
 #include <QBoxLayout>
+#include <QCache>
 #include <QCalendarWidget>
 #include <QCheckBox>
 #include <QClipboard>
+#include <QCollator>
 #include <QColorDialog>
 #include <QComboBox>
+#include <QCryptographicHash>
+#include <QDataStream>
 #include <QDate>
 #include <QDBusConnection>
 #include <QDBusConnectionInterface>
-#include <QDBusInterface>
+#include <QDBusMessage>
+#include <QDBusPendingCallWatcher>
+#include <QDBusPendingReply>
+#include <QDeadlineTimer>
 #include <QDesktopWidget>
 #include <QDialogButtonBox>
 #include <QDoubleSpinBox>
+#include <QElapsedTimer>
 #include <QEvent>
 #include <QFileDialog>
+#include <QFileInfo>
 #include <QFileSystemWatcher>
 #include <QFontDialog>
 #include <QFormLayout>
+#include <QFutureWatcher>
 #include <QHeaderView>
 #include <QIcon>
+#include <QImageReader>
 #include <QInputDialog>
+#include <QKeyEvent>
 #include <QLocale>
 #include <QLineEdit>
 #include <QMenuBar>
 #include <QMessageBox>
+#include <QMouseEvent>
+#include <QMutex>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QPainter>
+#include <QPixmapCache>
+#include <QPointer>
 #include <QProcess>
+#include <QProgressBar>
 #include <QProgressDialog>
 #include <QPropertyAnimation>
 #include <QPushButton>
+#include <QQueue>
 #include <QRadioButton>
+#include <QRunnable>
+#include <QSaveFile>
 #include <QScreen>
 #include <QScrollBar>
+#include <QSet>
 #include <QSettings>
+#include <QSharedPointer>
+#include <QShortcut>
 #include <QSlider>
 #include <QSocketNotifier>
+#include <QSortFilterProxyModel>
 #include <QSpinBox>
+#include <QStandardPaths>
 #include <QStringBuilder>
 #include <QStringList>
 #include <QStyledItemDelegate>
+#include <QStyleOptionButton>
 #include <QTabWidget>
 #include <QTextBrowser>
+#include <QTextCursor>
 #include <QTextCodec>
 #include <QThread>
+#include <QThreadPool>
 #include <QTimer>
 #include <QTimerEvent>
-#include <QTreeWidget>
-#include <QTreeWidgetItem>
+#include <QTreeView>
 
 #if QT_VERSION >= 0x050000
     // this is to hack access to the --title parameter in Qt5
     #include <QWindow>
 #endif
 
+#include <QtConcurrent>
 #include <QtDebug>
+#include <QtEndian>
+#include <QtNumeric>
 
+#include <algorithm>
 #include <cfloat>
+#include <cstring>
+#include <functional>
 
 #ifdef Q_OS_UNIX
+    #include <cerrno>
+    #include <climits>
+    #include <fcntl.h>
+    #include <poll.h>
     #include <signal.h>
+    #include <sys/socket.h>
+    #include <sys/stat.h>
+    #include <sys/un.h>
     #include <unistd.h>
+    extern char **environ;
 #endif
 
 #include "qrcodegen/qrcodegen.hpp"
@@ -130,6 +181,7 @@
 
 #define SHOW_DIALOG \
     m_dialog = dlg; \
+    indexWidgets(dlg); \
     connect(dlg, SIGNAL(finished(int)), SLOT(dialogFinished(int))); \
     if (!m_size.isNull()) { \
         dlg->adjustSize(); \
@@ -174,62 +226,11 @@
 
 #define SET_WIDGET_SETTINGS(ARG) \
     ws = WidgetSettings(); \
-    next_arg_split = next_arg.split('@'); \
-    foreach (QString setting, next_arg_split) { \
-        if      (setting.startsWith("addLabel=")) ws.addLabel = getWidgetSettingQString(setting); \
-        else if (setting.startsWith("addNewRowButton=")) ws.addNewRowButton = getWidgetSettingBool(setting); \
-        else if (setting.startsWith("backgroundColor=")) ws.backgroundColor = getWidgetSettingQString(setting); \
-        else if (setting.startsWith("buttonText=")) ws.buttonText = getWidgetSettingQString(setting); \
-        else if (setting.startsWith("command=")) ws.command = getWidgetSettingQString(setting); \
-        else if (setting.startsWith("commandToFooter=")) ws.commandToFooter = getWidgetSettingBool(setting); \
-        else if (setting.startsWith("defaultIndex=")) ws.defaultIndex = getWidgetSettingInt(setting); \
-        else if (setting.startsWith("defMarkerVal1=")) ws.defMarkerVal1 = getWidgetSettingQString(setting); \
-        else if (setting.startsWith("defMarkerVal2=")) ws.defMarkerVal2 = getWidgetSettingQString(setting); \
-        else if (setting.startsWith("defMarkerVal3=")) ws.defMarkerVal3 = getWidgetSettingQString(setting); \
-        else if (setting.startsWith("defMarkerVal4=")) ws.defMarkerVal4 = getWidgetSettingQString(setting); \
-        else if (setting.startsWith("defMarkerVal5=")) ws.defMarkerVal5 = getWidgetSettingQString(setting); \
-        else if (setting.startsWith("defMarkerVal6=")) ws.defMarkerVal6 = getWidgetSettingQString(setting); \
-        else if (setting.startsWith("defMarkerVal7=")) ws.defMarkerVal7 = getWidgetSettingQString(setting); \
-        else if (setting.startsWith("defMarkerVal8=")) ws.defMarkerVal8 = getWidgetSettingQString(setting); \
-        else if (setting.startsWith("defMarkerVal9=")) ws.defMarkerVal9 = getWidgetSettingQString(setting); \
-        else if (setting.startsWith("disableButtons=")) ws.disableButtons = getWidgetSettingBool(setting); \
-        else if (setting.startsWith("excludeFromOutput=")) ws.excludeFromOutput = getWidgetSettingBool(setting); \
-        else if (setting.startsWith("foregroundColor=")) ws.foregroundColor = getWidgetSettingQString(setting); \
-        else if (setting.startsWith("hideLabel=")) ws.hideLabel = getWidgetSettingBool(setting); \
-        else if (setting.startsWith("image=")) ws.image = getWidgetSettingQString(setting); \
-        else if (setting.startsWith("keepOpen=")) ws.keepOpen = getWidgetSettingBool(setting); \
-        else if (setting.startsWith("monitor=")) ws.monitorFile = getWidgetSettingBool(setting); \
-        else if (setting.startsWith("monitorMarkerFile1=")) ws.monitorMarkerFile1 = getWidgetSettingQString(setting); \
-        else if (setting.startsWith("monitorMarkerFile2=")) ws.monitorMarkerFile2 = getWidgetSettingQString(setting); \
-        else if (setting.startsWith("monitorMarkerFile3=")) ws.monitorMarkerFile3 = getWidgetSettingQString(setting); \
-        else if (setting.startsWith("monitorMarkerFile4=")) ws.monitorMarkerFile4 = getWidgetSettingQString(setting); \
-        else if (setting.startsWith("monitorMarkerFile5=")) ws.monitorMarkerFile5 = getWidgetSettingQString(setting); \
-        else if (setting.startsWith("monitorMarkerFile6=")) ws.monitorMarkerFile6 = getWidgetSettingQString(setting); \
-        else if (setting.startsWith("monitorMarkerFile7=")) ws.monitorMarkerFile7 = getWidgetSettingQString(setting); \
-        else if (setting.startsWith("monitorMarkerFile8=")) ws.monitorMarkerFile8 = getWidgetSettingQString(setting); \
-        else if (setting.startsWith("monitorMarkerFile9=")) ws.monitorMarkerFile9 = getWidgetSettingQString(setting); \
-        else if (setting.startsWith("monitorVarName1=")) ws.monitorVarName1 = getWidgetSettingQString(setting); \
-        else if (setting.startsWith("monitorVarName2=")) ws.monitorVarName2 = getWidgetSettingQString(setting); \
-        else if (setting.startsWith("monitorVarName3=")) ws.monitorVarName3 = getWidgetSettingQString(setting); \
-        else if (setting.startsWith("monitorVarName4=")) ws.monitorVarName4 = getWidgetSettingQString(setting); \
-        else if (setting.startsWith("monitorVarName5=")) ws.monitorVarName5 = getWidgetSettingQString(setting); \
-        else if (setting.startsWith("monitorVarName6=")) ws.monitorVarName6 = getWidgetSettingQString(setting); \
-        else if (setting.startsWith("monitorVarName7=")) ws.monitorVarName7 = getWidgetSettingQString(setting); \
-        else if (setting.startsWith("monitorVarName8=")) ws.monitorVarName8 = getWidgetSettingQString(setting); \
-        else if (setting.startsWith("monitorVarName9=")) ws.monitorVarName9 = getWidgetSettingQString(setting); \
-        else if (setting.startsWith("sep=")) ws.sep = getWidgetSettingQString(setting); \
-        else if (setting.startsWith("stop=")) ws.stop = getWidgetSettingBool(setting); \
-        else if (setting.startsWith("valuesToFooter=")) ws.valuesToFooter = getWidgetSettingBool(setting); \
-        else if (setting.startsWith("verboseTabBar=")) ws.verboseTabBar = getWidgetSettingBool(setting); \
-        else    next_arg_join << setting; \
-    } \
-    next_arg = next_arg_join.join('@'); \
-    next_arg_split.clear(); \
-    next_arg_join.clear();
+    next_arg = readWidgetSettings(ARG, ws);
 
 #define SWITCH_FORM_WIDGET(NEW_WIDGET) \
-    if (lastWidgetId == "text-browser") setTextInfo(lastTextBrowser); \
-    else if (lastWidgetId == "text-info") setTextInfo(lastTextInfo); \
+    if (lastWidgetId == "text-browser" && !m_formsValuesOnly) setTextInfo(lastTextBrowser); \
+    else if (lastWidgetId == "text-info" && (!m_formsValuesOnly || hasTextInfoValue(lastTextInfo))) setTextInfo(lastTextInfo); \
     if (!lastWidgetVar.isEmpty() && lastWidget) lastWidget->setProperty("guid_var", lastWidgetVar); \
     lastWidgetId = NEW_WIDGET;
 
@@ -410,6 +411,158 @@ InputGuard *InputGuard::s_instance = NULL;
 
 // End of "class InputGuard"
 
+/******************************************************************************
+ * class TraceSpan
+ ******************************************************************************/
+
+// Scope written as a Chrome trace event (Perfetto, chrome://tracing) to the file of
+// --trace=FILE or GUID_TRACE=FILE when it ends. A span costs a pointer test when tracing
+// is off. Events are appended to a JSON array, which both viewers load even if guid
+// didn't get to close it. Worker threads write spans too, so the file is published
+// through an atomic pointer and only written or closed under the mutex.
+class TraceSpan
+{
+public:
+    explicit TraceSpan(const char *name) : m_name(name), m_start(now()) {}
+    ~TraceSpan() {
+        if (isOn())
+            write(m_name, m_start, m_args);
+    }
+    
+    template <class T> void arg(const char *key, const T &value) {
+        if (isOn())
+            m_args += (m_args.isEmpty() ? "" : ",") + member(key, value);
+    }
+    
+    static bool isOn() { return s_file.loadAcquire(); }
+    // Microseconds since start(), 0 when tracing is off.
+    static qint64 now() { return isOn() ? s_clock.nsecsElapsed() / 1000 : 0; }
+    
+    static QByteArray member(const char *key, qint64 value) {
+        return '"' + QByteArray(key) + "\":" + QByteArray::number(value);
+    }
+    static QByteArray member(const char *key, const QString &value) {
+        return '"' + QByteArray(key) + "\":" + quote(value.toUtf8());
+    }
+    
+    // Spans read the clock without the mutex, so a trace being written is kept.
+    static void start(const QString &path) {
+        QMutexLocker locker(&s_mutex);
+        if (s_file.loadAcquire())
+            return;
+        QFile *file = new QFile(path);
+        if (!file->open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            qDebug().noquote() << "can't write the trace to" << path;
+            delete file;
+            return;
+        }
+        file->write("[\n");
+        s_clock.start();
+        s_events = 0;
+        s_threads.clear();
+        s_file.storeRelease(file);
+    }
+    
+    static void finish() {
+        QMutexLocker locker(&s_mutex);
+        QFile *file = s_file.fetchAndStoreOrdered(NULL);
+        if (!file)
+            return;
+        file->write("\n]\n");
+        delete file;
+    }
+    
+    // Complete event from start to now, args are comma-separated member()s.
+    static void write(const char *name, qint64 start, const QByteArray &args = QByteArray()) {
+        if (!isOn())
+            return;
+        QMutexLocker locker(&s_mutex);
+        QFile *file = s_file.loadAcquire();
+        if (!file)
+            return; // finished meanwhile
+        const qint64 end = now();
+        Qt::HANDLE thread = QThread::currentThreadId();
+        if (!s_threads.contains(thread))
+            s_threads.insert(thread, s_threads.count() + 1);
+        QByteArray event = s_events++ ? ",\n" : "";
+        event += "{\"name\":" + quote(name) + ",\"ph\":\"X\",\"ts\":" + QByteArray::number(start) +
+                 ",\"dur\":" + QByteArray::number(end - start) +
+                 ",\"pid\":" + QByteArray::number(QCoreApplication::applicationPid()) +
+                 ",\"tid\":" + QByteArray::number(s_threads.value(thread)) + ",\"args\":{" + args + "}}";
+        file->write(event);
+    }
+    
+private:
+    static QByteArray quote(const QByteArray &utf8) {
+        QByteArray quoted = "\"";
+        foreach (char c, utf8) {
+            if (c == '"' || c == '\\')
+                quoted += '\\';
+            if (uchar(c) < 0x20)
+                quoted += "\\u00" + QByteArray::number(uchar(c), 16).rightJustified(2, '0');
+            else
+                quoted += c;
+        }
+        return quoted + '"';
+    }
+    
+    QByteArray m_args;
+    const char *m_name;
+    qint64 m_start;
+    static QElapsedTimer s_clock;
+    static int s_events;
+    static QAtomicPointer<QFile> s_file;
+    static QMutex s_mutex;
+    static QHash<Qt::HANDLE, int> s_threads;
+};
+
+QElapsedTimer TraceSpan::s_clock;
+int TraceSpan::s_events = 0;
+QAtomicPointer<QFile> TraceSpan::s_file;
+QMutex TraceSpan::s_mutex;
+QHash<Qt::HANDLE, int> TraceSpan::s_threads;
+
+// Writes the "first frame" span, from start to the end of the first paint of the widget.
+class FirstFrameTrace : public QObject
+{
+public:
+    static void watch(QWidget *w, qint64 start) {
+        if (TraceSpan::isOn())
+            w->installEventFilter(new FirstFrameTrace(start, w));
+    }
+protected:
+    bool eventFilter(QObject *o, QEvent *e) {
+        if (e->type() == QEvent::Paint) {
+            o->removeEventFilter(this);
+            // The children are painted in the same pass, which is over once the event loop
+            // gets back to the timer.
+            QTimer::singleShot(0, this, [this]() {
+                TraceSpan::write("first frame", m_start);
+                deleteLater();
+            });
+        }
+        return false;
+    }
+private:
+    FirstFrameTrace(qint64 start, QObject *parent) : QObject(parent), m_start(start) {}
+    qint64 m_start;
+};
+
+// The trace file of --trace=FILE or --trace FILE in args, GUID_TRACE otherwise.
+static QString traceFilePath(const QStringList &args)
+{
+    QString path = qEnvironmentVariable("GUID_TRACE");
+    for (int i = 1; i < args.count(); ++i) {
+        if (args.at(i).startsWith("--trace="))
+            path = args.at(i).mid(8);
+        else if (args.at(i) == "--trace" && i + 1 < args.count())
+            path = args.at(++i);
+    }
+    return path;
+}
+
+// End of "class TraceSpan"
+
 /******************************************************************************
  * class ReadOnlyColumn
  ******************************************************************************/
@@ -425,255 +578,2075 @@ public:
 // End of "class ReadOnlyColumn"
 
 /******************************************************************************
- * typedef
+ * class CheckColumn
  ******************************************************************************/
 
-typedef QPair<bool, QString> ValuePair;
-typedef QPair<QString, QString> Help;
-typedef QList<Help> HelpList;
-typedef QPair<QString, HelpList> CategoryHelp;
-typedef QMap<QString, CategoryHelp> HelpDict;
+// Paints the checkbox or radio button of check and radio lists in place of a
+// widget per row. The state itself is the Qt::CheckStateRole of the model.
+class CheckColumn : public ReadOnlyColumn {
+public:
+    CheckColumn(bool radio, QObject* parent = 0): ReadOnlyColumn(parent), m_radio(radio) {}
+    
+    virtual void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const {
+        QStyleOptionViewItem opt = option;
+        initStyleOption(&opt, index);
+        opt.features &= ~QStyleOptionViewItem::HasCheckIndicator;
+        opt.text = QString();
+        QStyle *style = opt.widget ? opt.widget->style() : QApplication::style();
+        style->drawControl(QStyle::CE_ItemViewItem, &opt, painter, opt.widget);
+        
+        QStyleOptionButton button;
+        button.rect = indicatorRect(option, style);
+        button.state = option.state & QStyle::State_Enabled;
+        button.state |= index.data(Qt::CheckStateRole).toInt() == Qt::Checked ? QStyle::State_On : QStyle::State_Off;
+        style->drawPrimitive(m_radio ? QStyle::PE_IndicatorRadioButton : QStyle::PE_IndicatorCheckBox,
+                             &button, painter, opt.widget);
+    }
+    
+    virtual QSize sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const {
+        QStyle *style = option.widget ? option.widget->style() : QApplication::style();
+        QSize size = indicatorRect(option, style).size();
+        return size.expandedTo(QStyledItemDelegate::sizeHint(option, index)) + QSize(8, 0);
+    }
+    
+protected:
+    virtual bool editorEvent(QEvent *event, QAbstractItemModel *model, const QStyleOptionViewItem &option,
+                             const QModelIndex &index) {
+        if (!(index.flags() & Qt::ItemIsUserCheckable) || !(index.flags() & Qt::ItemIsEnabled))
+            return false;
+        
+        switch (event->type()) {
+            case QEvent::MouseButtonPress:
+            case QEvent::MouseButtonDblClick:
+                return static_cast<QMouseEvent*>(event)->button() == Qt::LeftButton;
+            case QEvent::MouseButtonRelease:
+                if (static_cast<QMouseEvent*>(event)->button() != Qt::LeftButton ||
+                    !option.rect.contains(static_cast<QMouseEvent*>(event)->pos()))
+                    return false;
+                break;
+            case QEvent::KeyPress:
+                if (static_cast<QKeyEvent*>(event)->key() != Qt::Key_Space &&
+                    static_cast<QKeyEvent*>(event)->key() != Qt::Key_Select)
+                    return false;
+                break;
+            default:
+                return false;
+        }
+        
+        bool checked = index.data(Qt::CheckStateRole).toInt() == Qt::Checked;
+        if (m_radio && checked)
+            return true;
+        return model->setData(index, checked ? Qt::Unchecked : Qt::Checked, Qt::CheckStateRole);
+    }
+    
+private:
+    QRect indicatorRect(const QStyleOptionViewItem &option, QStyle *style) const {
+        int width = style->pixelMetric(m_radio ? QStyle::PM_ExclusiveIndicatorWidth : QStyle::PM_IndicatorWidth,
+                                       0, option.widget);
+        int height = style->pixelMetric(m_radio ? QStyle::PM_ExclusiveIndicatorHeight : QStyle::PM_IndicatorHeight,
+                                        0, option.widget);
+        return QStyle::alignedRect(option.direction, Qt::AlignCenter, QSize(width, height), option.rect);
+    }
+    
+    bool m_radio;
+};
 
-// End of "typedef"
+// End of "class CheckColumn"
 
 /******************************************************************************
- * static variables
+ * class IconCache
  ******************************************************************************/
 
-static QFile *gs_stdin = 0;
+// Row icons of image lists, shared by all the lists and kept in QPixmapCache. Each path is
+// decoded once, straight to the icon size, on a thread pool of its own. The latest requests
+// come from the rows being painted right now, so they are decoded first. Until an icon is
+// there, a blank one of the same size stands in and the receivers that asked for it are
+// called back. Decodes nobody waits for anymore are skipped.
+class IconCache : public QObject {
+public:
+    static IconCache *instance() {
+        static IconCache *cache = new IconCache(qApp);
+        return cache;
+    }
+    
+    // Drops the decodes not started yet, along with their waiters.
+    void cancel() {
+        m_pool.clear();
+        m_waiters.clear();
+        QMutexLocker locker(&m_wantedMutex);
+        m_wanted.clear();
+    }
+    
+    QIcon icon(const QString &path, const QSize &size, QObject *receiver, const std::function<void()> &ready,
+               bool *pending) {
+        const QString key = QString::number(size.width()) + 'x' + QString::number(size.height()) + ':' + path;
+        QPixmap pixmap;
+        *pending = !QPixmapCache::find(key, &pixmap);
+        if (!*pending)
+            return QIcon(pixmap);
+        
+        QList<Waiter> &waiters = m_waiters[key];
+        bool waiting = false;
+        foreach (const Waiter &waiter, waiters)
+            waiting = waiting || waiter.first == receiver;
+        if (!waiting)
+            waiters << Waiter(receiver, ready);
+        if (!m_receivers.contains(receiver)) {
+            m_receivers.insert(receiver);
+            connect(receiver, &QObject::destroyed, this, [=](QObject *gone) { dropReceiver(gone); });
+        }
+        if (waiters.count() == 1 && !waiting) {
+            m_wantedMutex.lock();
+            m_wanted.insert(key);
+            m_wantedMutex.unlock();
+            m_pool.start(new Decoder(this, key, path, size, qApp->devicePixelRatio()), ++m_requests);
+        }
+        return placeholder(size);
+    }
+    
+private:
+    typedef QPair<QPointer<QObject>, std::function<void()> > Waiter;
+    
+    class Decoder : public QRunnable {
+    public:
+        Decoder(IconCache *cache, const QString &key, const QString &path, const QSize &size, qreal ratio) :
+            m_cache(cache), m_key(key), m_path(path), m_ratio(ratio), m_size(size) {}
+        
+        void run() {
+            if (!m_cache->isWanted(m_key))
+                return;
+            const QSize size = m_size * m_ratio;
+            QImageReader reader(m_path);
+            const QSize imageSize = reader.size();
+            if (imageSize.isValid() && (imageSize.width() > size.width() || imageSize.height() > size.height()))
+                reader.setScaledSize(imageSize.scaled(size, Qt::KeepAspectRatio));
+            QImage image = reader.read();
+            image.setDevicePixelRatio(m_ratio);
+            IconCache *cache = m_cache;
+            const QString key = m_key;
+            const QSize iconSize = m_size;
+            QMetaObject::invokeMethod(cache, [=]() { cache->decoded(key, image, iconSize); }, Qt::QueuedConnection);
+        }
+        
+    private:
+        IconCache *m_cache;
+        QString m_key;
+        QString m_path;
+        qreal m_ratio;
+        QSize m_size;
+    };
+    
+    IconCache(QObject *parent) : QObject(parent), m_requests(0) {
+        // Thumbnails are small, but there are thousands of them in some lists.
+        QPixmapCache::setCacheLimit(qMax(QPixmapCache::cacheLimit(), 64 * 1024));
+        connect(qApp, &QCoreApplication::aboutToQuit, this, &IconCache::cancel);
+    }
+    
+    bool isWanted(const QString &key) {
+        QMutexLocker locker(&m_wantedMutex);
+        return m_wanted.contains(key);
+    }
+    
+    // Called from the GUI thread only.
+    void dropReceiver(QObject *receiver) {
+        m_receivers.remove(receiver);
+        QMutexLocker locker(&m_wantedMutex);
+        for (auto it = m_waiters.begin(); it != m_waiters.end();) {
+            QList<Waiter> &waiters = it.value();
+            for (int i = waiters.count() - 1; i >= 0; --i) {
+                if (!waiters.at(i).first || waiters.at(i).first == receiver)
+                    waiters.removeAt(i);
+            }
+            if (waiters.isEmpty()) {
+                m_wanted.remove(it.key());
+                it = m_waiters.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+    
+    void decoded(const QString &key, const QImage &image, const QSize &size) {
+        // Unreadable images get the blank icon for good, as QPixmap(path) used to.
+        QPixmapCache::insert(key, image.isNull() ? placeholder(size).pixmap(size) : QPixmap::fromImage(image));
+        m_wantedMutex.lock();
+        m_wanted.remove(key);
+        m_wantedMutex.unlock();
+        foreach (const Waiter &waiter, m_waiters.take(key)) {
+            if (waiter.first)
+                waiter.second();
+        }
+    }
+    
+    QIcon placeholder(const QSize &size) {
+        const int key = size.width() << 16 | size.height();
+        if (!m_placeholders.contains(key)) {
+            QPixmap blank(size);
+            blank.fill(Qt::transparent);
+            m_placeholders.insert(key, QIcon(blank));
+        }
+        return m_placeholders.value(key);
+    }
+    
+    QHash<int, QIcon> m_placeholders;
+    QSet<QObject*> m_receivers;
+    int m_requests;
+    QHash<QString, QList<Waiter> > m_waiters;
+    QSet<QString> m_wanted; // keys with a live waiter, read by the decoders
+    QMutex m_wantedMutex;
+    QThreadPool m_pool; // last, so that it waits for the running decoders first
+};
 
-// End of "static variables"
+// End of "class IconCache"
 
 /******************************************************************************
- * static functions
+ * class ListModel
  ******************************************************************************/
 
-static QSize getQTreeWidgetSize(QTreeWidget **qtw)
-{
-    QTreeWidget *tw = *qtw;
-    int rows = 0;
-    int height = 2 * tw->frameWidth();
-    if (!tw->isHeaderHidden())
-        height += tw->header()->sizeHint().height();
+// Flat, column-major storage for list values. Rows don't own any object, so a
+// list with hundreds of thousands of rows only costs its strings, and the view
+// only queries the rows it actually paints.
+class ListModel : public QAbstractTableModel {
+public:
+    ListModel(int columnCount, QObject *parent = 0) : QAbstractTableModel(parent),
+        m_checkable(false), m_columns(qMax(columnCount, 1)), m_flags(Qt::NoItemFlags),
+        m_iconAllRows(false), m_icons(false), m_iconSize(16, 16), m_iconUpdate(false), m_multiLine(false),
+        m_revision(0), m_rowCount(0) {}
     
-    for (int i = 0; i < tw->topLevelItemCount(); ++i) {
-        rows += 1;
-        QTreeWidgetItem *twi = tw->topLevelItem(i);
-        QRect rec = twi->treeWidget()->visualItemRect(twi);
-        height += rec.height();
+    int columnCount(const QModelIndex &parent = QModelIndex()) const {
+        return parent.isValid() ? 0 : m_columns.count();
     }
     
-    return QSize(tw->header()->length() + 2 * tw->frameWidth(), height);
-}
-
-static QStringList addColumnToListValues(QStringList values, QString addValue, int nbColumns)
-{
-    QStringList result;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const {
+        return parent.isValid() ? 0 : m_rowCount;
+    }
     
-    if (!addValue.isEmpty()) {
-        int moduloComp = nbColumns - 1;
-        if (moduloComp <= 0)
-            moduloComp = 1;
-        int i = 0;
-        foreach(QString v, values) {
-            if (i % moduloComp == 0) {
-                result << addValue;
-            }
-            result << v;
-            i++;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const {
+        if (!index.isValid())
+            return QVariant();
+        const QString &value = m_columns.at(index.column()).at(index.row());
+        switch (role) {
+            case Qt::DisplayRole:
+                // The first column of check and image lists holds the state or the
+                // image path, which isn't displayed as text.
+                if (index.column() == 0 && (m_checkable || m_icons))
+                    return QString();
+                return value;
+            case Qt::EditRole:
+                return value;
+            case Qt::CheckStateRole:
+                if (index.column() == 0 && m_checkable)
+                    return m_checked.at(index.row()) ? Qt::Checked : Qt::Unchecked;
+                break;
+            case Qt::DecorationRole:
+                if (index.column() == 0 && m_icons) {
+                    bool pending;
+                    ListModel *model = const_cast<ListModel*>(this);
+                    QIcon icon = IconCache::instance()->icon(value, m_iconSize, model, [=]() {
+                        model->iconReady(value);
+                    }, &pending);
+                    if (pending && !m_iconRows.contains(value, index.row()))
+                        m_iconRows.insert(value, index.row());
+                    return icon;
+                }
+                break;
+            default:
+                break;
         }
-    } else {
-        result = values;
+        return QVariant();
     }
     
-    return result;
-}
-
-static void addItems(QTreeWidget *tw, QStringList &values, bool editable, bool checkable, bool icons)
-{
-    QString selectionType = tw->property("guid_list_selection_type").toString();
-    
-    for (int i = 0; i < values.count(); ) {
-        QStringList itemValues;
-        for (int j = 0; j < tw->columnCount(); ++j) {
-            itemValues << values.at(i++);
-            if (i == values.count())
-                break;
+    bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole) {
+        if (!index.isValid())
+            return false;
+        if (role == Qt::EditRole) {
+            m_columns[index.column()][index.row()] = value.toString();
+            noteLines(m_columns.at(index.column()).at(index.row()));
+            ++m_revision;
+        } else if (role == Qt::CheckStateRole && index.column() == 0 && m_checkable) {
+            bool checked = value.toInt() == Qt::Checked;
+            if (m_checked.at(index.row()) == checked)
+                return true;
+            m_checked[index.row()] = checked;
+        } else {
+            return false;
         }
-        
-        QTreeWidgetItem *item = new QTreeWidgetItem(tw, itemValues);
-        tw->addTopLevelItem(item);
-        
-        Qt::ItemFlags flags = item->flags();
-        if (editable)
-            flags |= Qt::ItemIsEditable;
-        item->setFlags(flags);
-        
-        if (selectionType == "checklist") {
-            QCheckBox *cb = new QCheckBox();
-            cb->setContentsMargins(0, 0, 0, 0);
-            if (itemValues.at(0).toLower() == "true")
-                cb->setCheckState(Qt::Checked);
-            else
-                cb->setCheckState(Qt::Unchecked);
-            cb->setStyleSheet("QCheckBox::indicator {subcontrol-position: center center;}");
-            tw->setItemWidget(item, 0, cb);
-        } else if (selectionType == "radiolist") {
-            QRadioButton *rb = new QRadioButton();
-            rb->setContentsMargins(0, 0, 0, 0);
-            if (itemValues.at(0).toLower() == "true")
-                rb->setChecked(true);
-            else
-                rb->setChecked(false);
-            rb->setStyleSheet("QRadioButton::indicator {subcontrol-position: center center;}");
-            tw->setItemWidget(item, 0, rb);
+        emit dataChanged(index, index);
+        return true;
+    }
+    
+    Qt::ItemFlags flags(const QModelIndex &index) const {
+        if (!index.isValid())
+            return Qt::NoItemFlags;
+        if (index.column() == 0 && m_checkable)
+            return Qt::ItemIsSelectable | Qt::ItemIsEnabled | Qt::ItemIsUserCheckable;
+        return Qt::ItemIsSelectable | Qt::ItemIsEnabled | m_flags;
+    }
+    
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const {
+        if (orientation == Qt::Horizontal && role == Qt::DisplayRole && section < m_headers.count())
+            return m_headers.at(section);
+        return QAbstractTableModel::headerData(section, orientation, role);
+    }
+    
+    // values are given row after row, as they are read from the command line or stdin.
+    void appendValues(const QStringList &values) {
+        insertValues(m_rowCount, values);
+    }
+    
+    void insertValues(int row, const QStringList &values) {
+        const int nbColumns = m_columns.count();
+        const int nbRows = (values.count() + nbColumns - 1) / nbColumns;
+        if (nbRows == 0)
+            return;
+        ++m_revision;
+        forgetIconRows(row < m_rowCount);
+        beginInsertRows(QModelIndex(), row, row + nbRows - 1);
+        m_checked.insert(row, nbRows, false);
+        for (int i = 0; i < nbRows; ++i)
+            m_checked[row + i] = values.at(i * nbColumns).toLower() == "true";
+        for (int j = 0; j < nbColumns; ++j) {
+            QVector<QString> &column = m_columns[j];
+            column.insert(row, nbRows, QString());
+            for (int i = 0; i < nbRows; ++i) {
+                column[row + i] = values.value(i * nbColumns + j);
+                noteLines(column.at(row + i));
+            }
         }
-        if (icons)
-            item->setIcon(0, QPixmap(item->text(0)));
-        if (checkable || icons) {
-            item->setData(0, Qt::EditRole, item->text(0));
-            item->setText(0, QString());
+        m_rowCount += nbRows;
+        endInsertRows();
+    }
+    
+    bool removeRows(int row, int count, const QModelIndex &parent = QModelIndex()) {
+        if (parent.isValid() || count < 1 || row < 0 || row + count > m_rowCount)
+            return false;
+        ++m_revision;
+        forgetIconRows(true);
+        beginRemoveRows(QModelIndex(), row, row + count - 1);
+        m_checked.remove(row, count);
+        for (int j = 0; j < m_columns.count(); ++j)
+            m_columns[j].remove(row, count);
+        m_rowCount -= count;
+        endRemoveRows();
+        return true;
+    }
+    
+    // Replaces the content by values, but only the rows between the unchanged head
+    // and tail are removed and inserted again. Appending to the file is thus a plain
+    // insert, and the other rows keep their check state and selection.
+    void updateValues(const QStringList &values) {
+        const int nbColumns = m_columns.count();
+        const int nbRows = (values.count() + nbColumns - 1) / nbColumns;
+        int head = 0;
+        while (head < m_rowCount && head < nbRows && rowEquals(head, values, head))
+            ++head;
+        int tail = 0;
+        while (tail < m_rowCount - head && tail < nbRows - head &&
+               rowEquals(m_rowCount - 1 - tail, values, nbRows - 1 - tail))
+            ++tail;
+        removeRows(head, m_rowCount - head - tail);
+        insertValues(head, values.mid(head * nbColumns, (nbRows - head - tail) * nbColumns));
+    }
+    
+    void appendRow(const QStringList &values = QStringList()) {
+        ++m_revision;
+        beginInsertRows(QModelIndex(), m_rowCount, m_rowCount);
+        m_checked.append(!values.isEmpty() && values.at(0).toLower() == "true");
+        for (int j = 0; j < m_columns.count(); ++j) {
+            m_columns[j].append(j < values.count() ? values.at(j) : QString());
+            noteLines(m_columns.at(j).last());
         }
+        ++m_rowCount;
+        endInsertRows();
     }
-}
-
-static void buildFormsList(QTreeWidget **tree, GList &list, QStringList &columns, bool &showHeader,
-                           Qt::ItemFlags &flags, int &height)
-{
-    QTreeWidget *tw = *tree;
-
-    if (!tw)
-        return;
     
-    tw->setRootIsDecorated(false);
-    int columnCount = columns.count();
-    tw->setHeaderHidden(!showHeader);
-    if (columns.count()) {
-        tw->setColumnCount(columns.count());
-        tw->setHeaderLabels(columns);
-    } else {
-        columnCount = 1;
+    void clear() {
+        ++m_revision;
+        beginResetModel();
+        for (int j = 0; j < m_columns.count(); ++j)
+            m_columns[j].clear();
+        m_checked.clear();
+        m_multiLine = false;
+        m_rowCount = 0;
+        forgetIconRows(false);
+        endResetModel();
     }
     
-    list.val = addColumnToListValues(list.val, list.addValue, columnCount);
-    QString selectionType = tw->property("guid_list_selection_type").toString();
+    void setColumnCount(int columnCount) {
+        ++m_revision;
+        beginResetModel();
+        m_columns = QVector<QVector<QString> >(qMax(columnCount, 1));
+        m_checked.clear();
+        m_multiLine = false;
+        m_rowCount = 0;
+        forgetIconRows(false);
+        endResetModel();
+    }
     
-    for (int i = 0; i < list.val.count(); ) {
-        QStringList itemValues;
-        for (int j = 0; j < columnCount; ++j) {
-            itemValues << list.val.at(i++);
-            if (i == list.val.count())
-                break;
+    bool hasIcons() const { return m_icons; }
+    // Whether a value ever stored spans several lines, rows then differ in height.
+    bool hasMultiLineValues() const { return m_multiLine; }
+    bool isCheckable() const { return m_checkable; }
+    bool isChecked(int row) const { return m_checkable && m_checked.at(row); }
+    void setCheckable(bool checkable) { m_checkable = checkable; }
+    Qt::ItemFlags itemFlags() const { return m_flags; }
+    void setItemFlags(Qt::ItemFlags flags) { m_flags = flags; }
+    void setHeaderLabels(const QStringList &labels) { m_headers = labels; }
+    void setIcons(bool icons) { m_icons = icons; }
+    void setIconSize(const QSize &size) { m_iconSize = size; }
+    // Bumped by every change of the values, a copy of column() is current as long as it's the same.
+    int revision() const { return m_revision; }
+    QVector<QString> column(int column) const { return m_columns.at(column); }
+    QString text(int row, int column) const { return m_columns.at(column).at(row); }
+    
+private:
+    enum { IconUpdateMs = 30 };
+    
+    // Rows moved by an insert or a remove no longer match m_iconRows, so the next decoded
+    // icon repaints the whole column, which only costs the visible rows to the view.
+    void forgetIconRows(bool moved) {
+        m_iconAllRows = m_iconAllRows || (moved && !m_iconRows.isEmpty());
+        m_iconRows.clear();
+        if (!moved)
+            m_iconAllRows = false;
+    }
+    
+    // The rows that got a placeholder for path are repainted, along with the other icons
+    // decoded in the meantime.
+    void iconReady(const QString &path) {
+        const bool scheduled = m_iconUpdate;
+        if (m_iconAllRows && m_rowCount > 0) {
+            m_iconAllRows = false;
+            m_iconFirst = 0;
+            m_iconLast = m_rowCount - 1;
+            m_iconUpdate = true;
+        }
+        foreach (int row, m_iconRows.values(path)) {
+            if (row >= m_rowCount)
+                continue;
+            if (!m_iconUpdate || row < m_iconFirst)
+                m_iconFirst = row;
+            if (!m_iconUpdate || row > m_iconLast)
+                m_iconLast = row;
+            m_iconUpdate = true;
+        }
+        m_iconRows.remove(path);
+        if (m_iconUpdate && !scheduled) {
+            QTimer::singleShot(IconUpdateMs, this, [=]() {
+                m_iconUpdate = false;
+                const int last = qMin(m_iconLast, m_rowCount - 1);
+                if (m_iconFirst <= last)
+                    emit dataChanged(index(m_iconFirst, 0), index(last, 0), QVector<int>() << Qt::DecorationRole);
+            });
         }
-        QTreeWidgetItem *item = new QTreeWidgetItem(tw, itemValues);
-        tw->addTopLevelItem(item);
-        
-        flags |= item->flags();
-        item->setFlags(flags);
-        item->setTextAlignment(0, Qt::AlignLeft);
-        
-        if (selectionType == "checklist") {
-            QCheckBox *cb = new QCheckBox();
-            cb->setContentsMargins(0, 0, 0, 0);
-            if (itemValues.at(0).toLower() == "true")
-                cb->setCheckState(Qt::Checked);
-            else
-                cb->setCheckState(Qt::Unchecked);
-            cb->setStyleSheet("QCheckBox::indicator {subcontrol-position: center center;}");
-            tw->setItemWidget(item, 0, cb);
-        } else if (selectionType == "radiolist") {
-            QRadioButton *rb = new QRadioButton();
-            rb->setContentsMargins(0, 0, 0, 0);
-            if (itemValues.at(0).toLower() == "true")
-                rb->setChecked(true);
-            else
-                rb->setChecked(false);
-            rb->setStyleSheet("QRadioButton::indicator {subcontrol-position: center center;}");
-            tw->setItemWidget(item, 0, rb);
+    }
+    
+    void noteLines(const QString &value) {
+        m_multiLine = m_multiLine || value.contains('\n') || value.contains('\r');
+    }
+    
+    bool rowEquals(int row, const QStringList &values, int valuesRow) const {
+        for (int j = 0; j < m_columns.count(); ++j) {
+            if (m_columns.at(j).at(row) != values.value(valuesRow * m_columns.count() + j))
+                return false;
         }
-        
-        if (!selectionType.isEmpty())
-            item->setText(0, QString());
+        return true;
     }
+    
+    bool m_checkable;
+    QVector<bool> m_checked;
+    QVector<QVector<QString> > m_columns;
+    Qt::ItemFlags m_flags;
+    QStringList m_headers;
+    bool m_iconAllRows;
+    int m_iconFirst;
+    int m_iconLast;
+    mutable QMultiHash<QString, int> m_iconRows;
+    bool m_icons;
+    QSize m_iconSize;
+    bool m_iconUpdate;
+    bool m_multiLine;
+    int m_revision;
+    int m_rowCount;
+};
 
-    for (int i = 0; i < columns.count(); ++i)
-        tw->resizeColumnToContents(i);
-
-    if (!selectionType.isEmpty())
-        tw->header()->setSectionResizeMode(0, QHeaderView::Fixed);
+// End of "class ListModel"
 
-    tw->setStyleSheet(QTREEWIDGET_STYLE);
+/******************************************************************************
+ * class ListFilter
+ ******************************************************************************/
 
-    if (height >= 0) {
-        QSizePolicy twSizePolicy = tw->sizePolicy();
-        twSizePolicy.setVerticalPolicy(QSizePolicy::Fixed);
-        tw->setSizePolicy(twSizePolicy);
-        if (height < getQTreeWidgetSize(&tw).height())
-            tw->setFixedHeight(height);
+// Filters the rows of a ListModel with the text of the --mid-search line edit. Keystrokes
+// are debounced, then the rows are scanned on the thread pool against a case-folded copy
+// of the searched columns, which is made once and kept until the model changes. When the
+// query only grows, just the rows that matched the previous one are scanned again. The
+// matching rows are applied all at once when the scan is done.
+// Sorting by a header works the same way: the thread pool computes one key per row of the
+// column and sorts a permutation of the rows by key, chunks in parallel then merged, and
+// the proxy then sorts with the resulting ranks, which are compared as plain integers.
+class ListFilter : public QSortFilterProxyModel {
+public:
+    enum SortType { AutoSort, NumericSort, NaturalSort, TextSort };
+    
+    ListFilter(ListModel *model, bool allColumns, QObject *parent = 0) : QSortFilterProxyModel(parent),
+        m_allColumns(allColumns), m_foldedRevision(-1), m_model(model), m_rankColumn(-1), m_rankId(0),
+        m_rankRevision(-1), m_rankType(NaturalSort), m_rankedColumn(-1), m_rankedOrder(Qt::AscendingOrder),
+        m_revision(-1), m_scanId(0) {
+        setSourceModel(model);
+        m_naturalCollator.setNumericMode(true);
+        m_naturalCollator.setCaseSensitivity(Qt::CaseInsensitive);
+        m_timer.setSingleShot(true);
+        connect(&m_timer, &QTimer::timeout, this, [=]() { scan(); });
+        m_rankTimer.setSingleShot(true);
+        connect(&m_rankTimer, &QTimer::timeout, this, [=]() { rank(m_rankedColumn, m_rankedOrder); });
+        connect(model, &QAbstractItemModel::rowsInserted, this, [=]() { rescan(); });
+        connect(model, &QAbstractItemModel::rowsRemoved, this, [=]() { rescan(); });
+        connect(model, &QAbstractItemModel::dataChanged, this, [=]() { rescan(); });
+        connect(model, &QAbstractItemModel::modelReset, this, [=]() { rescan(); });
     }
     
-    int roColumnNumber = tw->property("guid_list_read_only_column").toInt();
-    roColumnNumber = roColumnNumber - 1;
-    if (roColumnNumber >= 0 && roColumnNumber < columns.count())
-        tw->setItemDelegateForColumn(roColumnNumber, new ReadOnlyColumn(tw));
-
-    list = GList();
-    columns.clear();
-    showHeader = false;
-    flags = Qt::NoItemFlags;
-    height = -1;
-    *tree = NULL;
-}
-
-static ValuePair getFormsWidgetValue(const QWidget *w, const QString &dateFormat,
-                                     const QString &separator, const QString &listRowSeparator)
-{
-    if (!w || w->property("guid_hide").toBool())
-        return ValuePair(false, QString());
+    static bool sortTypeFromName(const QString &name, SortType &type) {
+        const int i = (QStringList() << "auto" << "numeric" << "natural" << "text").indexOf(name.toLower());
+        if (i < 0)
+            return false;
+        type = SortType(i);
+        return true;
+    }
     
-    QString var = w->property("guid_var").toString().simplified().replace(" ", "");
-    if (!var.isEmpty())
-        var += "=";
+    void setQuery(const QString &query) {
+        m_pendingQuery = query.toCaseFolded();
+        m_timer.start(DebounceMs);
+    }
     
-    IF_IS(QLineEdit) {
-        return ValuePair(true, var + t->text());
-    } else IF_IS(QTreeWidget) {
-        if (t->selectionMode() == QAbstractItemView::NoSelection ||
-            t->property("guid_list_exclude_from_output").toBool())
-            return ValuePair(false, QString());
-        
-        QString results = "";
-        QString rowValue;
-        QString printColumn = t->property("guid_list_print_column").toString();
-        QString printMode = t->property("guid_list_print_values_mode").toString();
-        QString selectionType = t->property("guid_list_selection_type").toString();
-        QList<QTreeWidgetItem*> itemsToCheck;
-        
-        if (selectionType == "checklist" || selectionType == "radiolist" || printMode == "all") {
-            for (int i = 0; i < t->topLevelItemCount(); ++i) {
-                QTreeWidgetItem *item = t->topLevelItem(i);
-                itemsToCheck << item;
+    void setSortType(int column, SortType type) { m_sortTypes.insert(column, type); }
+    
+    // The rows keep their order until the ranks are ready, then move all at once.
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) {
+        if (column < 0 || column >= m_model->columnCount() || isCheckColumn(column)) {
+            ++m_rankId;
+            m_rankedColumn = -1;
+            m_rankTimer.stop();
+            QSortFilterProxyModel::sort(column, order);
+            return;
+        }
+        rank(column, order);
+    }
+    
+protected:
+    bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const {
+        Q_UNUSED(sourceParent);
+        if (m_query.isEmpty())
+            return true;
+        if (m_revision == m_model->revision())
+            return m_matches.testBit(sourceRow);
+        // Rows inserted or edited since the last scan are matched here until the next one.
+        foreach (int column, searchedColumns()) {
+            if (m_model->text(sourceRow, column).toCaseFolded().contains(m_query))
+                return true;
+        }
+        return false;
+    }
+    
+    bool lessThan(const QModelIndex &left, const QModelIndex &right) const {
+        const int column = left.column();
+        if (isCheckColumn(column))
+            return !m_model->isChecked(left.row()) && m_model->isChecked(right.row());
+        if (column == m_rankColumn && m_rankRevision == m_model->revision())
+            return m_ranks.at(left.row()) < m_ranks.at(right.row());
+        // Rows inserted or edited since the last ranking are compared here until the next one.
+        const QString a = m_model->text(left.row(), column);
+        const QString b = m_model->text(right.row(), column);
+        SortType type = column == m_rankColumn ? m_rankType : m_sortTypes.value(column, AutoSort);
+        if (type == NumericSort)
+            return numericLess(numericKey(a), numericKey(b));
+        return (type == TextSort ? m_textCollator : m_naturalCollator).compare(a, b) < 0;
+    }
+    
+private:
+    enum { DebounceMs = 150, MaxWaitMs = 500, MinChunk = 16384 };
+    
+    struct Merge {
+        int first;
+        int middle;
+        int last;
+    };
+    
+    struct Ranks {
+        QVector<int> ranks;
+        SortType type;
+    };
+    
+    struct Scan {
+        QVector<QVector<QString> > folded;
+        QBitArray matches;
+    };
+    
+    // Ranges of rows for the threads of the pool, none of them smaller than MinChunk.
+    static QVector<QPair<int, int> > chunks(int count) {
+        const int nbChunks = qBound(1, count / MinChunk, qMax(QThread::idealThreadCount(), 1));
+        QVector<QPair<int, int> > ranges;
+        for (int k = 0; k < nbChunks; ++k)
+            ranges << qMakePair(int(qint64(count) * k / nbChunks), int(qint64(count) * (k + 1) / nbChunks));
+        return ranges;
+    }
+    
+    // Equal keys share a rank, the proxy's stable sort then keeps their order.
+    template <class Less> static QVector<int> sortedRanks(int count, const Less &less) {
+        QVector<int> rows(count);
+        for (int i = 0; i < count; ++i)
+            rows[i] = i;
+        int *data = rows.data();
+        QVector<QPair<int, int> > ranges = chunks(count);
+        QtConcurrent::blockingMap(ranges, [=](QPair<int, int> &range) {
+            std::sort(data + range.first, data + range.second, less);
+        });
+        while (ranges.count() > 1) {
+            QVector<QPair<int, int> > merged;
+            QVector<Merge> merges;
+            for (int k = 0; k + 1 < ranges.count(); k += 2) {
+                merged << qMakePair(ranges.at(k).first, ranges.at(k + 1).second);
+                merges << Merge{ranges.at(k).first, ranges.at(k + 1).first, ranges.at(k + 1).second};
             }
-        } else {
-            itemsToCheck = t->selectedItems();
+            if (ranges.count() % 2)
+                merged << ranges.last();
+            QtConcurrent::blockingMap(merges, [=](Merge &merge) {
+                std::inplace_merge(data + merge.first, data + merge.middle, data + merge.last, less);
+            });
+            ranges = merged;
         }
         
-        if (selectionType == "checklist" || selectionType == "radiolist") {
-            bool isChecked = false;
-            int itemNo = 0;
-            foreach (QTreeWidgetItem *item, itemsToCheck) {
-                if (selectionType == "checklist") {
-                    QCheckBox *cb = qobject_cast<QCheckBox*>(t->itemWidget(item, 0));
-                    isChecked = cb->isChecked();
-                } else if (selectionType == "radiolist") {
-                    QRadioButton *rb = qobject_cast<QRadioButton*>(t->itemWidget(item, 0));
-                    isChecked = rb->isChecked();
+        QVector<int> ranks(count);
+        for (int i = 0; i < count; ++i)
+            ranks[rows.at(i)] = i > 0 && !less(rows.at(i - 1), rows.at(i)) ? ranks.at(rows.at(i - 1)) : i;
+        return ranks;
+    }
+    
+    // Runs on the pool. A column set to auto is numeric when all its non-empty values are.
+    static Ranks columnRanks(const QVector<QString> &values, SortType type) {
+        Ranks result;
+        result.type = type == AutoSort ? NumericSort : type;
+        const int count = values.count();
+        QVector<QPair<int, int> > ranges = chunks(count);
+        
+        if (result.type == NumericSort) {
+            QVector<double> keys(count);
+            double *data = keys.data();
+            QAtomicInt mixed;
+            QtConcurrent::blockingMap(ranges, [&](QPair<int, int> &range) {
+                for (int i = range.first; i < range.second; ++i) {
+                    data[i] = numericKey(values.at(i));
+                    if (qIsNaN(data[i]) && !values.at(i).trimmed().isEmpty())
+                        mixed.storeRelaxed(1);
                 }
-                
-                if (isChecked || printMode == "all") {
-                    rowValue = "";
-                    for (int i = 0; i < t->columnCount(); ++i) {
-                        if (printColumn == "all" || printColumn == QString::number(i + 1)) {
+            });
+            if (type == NumericSort || !mixed.loadRelaxed()) {
+                result.ranks = sortedRanks(count, [&](int a, int b) { return numericLess(keys.at(a), keys.at(b)); });
+                return result;
+            }
+            result.type = NaturalSort;
+        }
+        
+        // QCollator isn't thread-safe: every chunk makes its keys with a collator of its own.
+        std::vector<std::vector<QCollatorSortKey> > parts(ranges.count());
+        QVector<int> indexes;
+        for (int k = 0; k < ranges.count(); ++k)
+            indexes << k;
+        const bool natural = result.type == NaturalSort;
+        QtConcurrent::blockingMap(indexes, [&](int &k) {
+            QCollator collator;
+            if (natural) {
+                collator.setNumericMode(true);
+                collator.setCaseSensitivity(Qt::CaseInsensitive);
+            }
+            parts[k].reserve(ranges.at(k).second - ranges.at(k).first);
+            for (int i = ranges.at(k).first; i < ranges.at(k).second; ++i)
+                parts[k].push_back(collator.sortKey(values.at(i)));
+        });
+        std::vector<QCollatorSortKey> keys;
+        keys.reserve(count);
+        for (size_t k = 0; k < parts.size(); ++k)
+            keys.insert(keys.end(), parts[k].begin(), parts[k].end());
+        parts.clear();
+        result.ranks = sortedRanks(count, [&](int a, int b) { return keys[a].compare(keys[b]) < 0; });
+        return result;
+    }
+    
+    // Values that aren't numbers sort after the numbers.
+    static double numericKey(const QString &value) {
+        bool ok;
+        const double key = value.trimmed().toDouble(&ok);
+        return ok ? key : qQNaN();
+    }
+    
+    static bool numericLess(double a, double b) { return !qIsNaN(a) && (qIsNaN(b) || a < b); }
+    
+    // The check state of check and radio lists isn't part of the values.
+    bool isCheckColumn(int column) const { return column == 0 && m_model->isCheckable(); }
+    
+    // The column stays ranked, values changed later get it ranked again.
+    void rank(int column, Qt::SortOrder order) {
+        if (column < 0)
+            return;
+        m_rankedColumn = column;
+        m_rankedOrder = order;
+        m_rankTimer.stop();
+        const int rankId = ++m_rankId;
+        const int revision = m_model->revision();
+        const QVector<QString> values = m_model->column(column);
+        const SortType type = m_sortTypes.value(column, AutoSort);
+        
+        QFutureWatcher<Ranks> *watcher = new QFutureWatcher<Ranks>(this);
+        connect(watcher, &QFutureWatcher<Ranks>::finished, this, [=]() {
+            if (rankId == m_rankId && revision == m_model->revision()) {
+                const Ranks result = watcher->result();
+                m_rankColumn = column;
+                m_ranks = result.ranks;
+                m_rankRevision = revision;
+                m_rankType = result.type;
+                if (sortColumn() == column && sortOrder() == order)
+                    invalidate(); // sort() is a no-op for the current column
+                else
+                    QSortFilterProxyModel::sort(column, order);
+            } else if (rankId == m_rankId) {
+                m_rankTimer.start(DebounceMs); // the values changed meanwhile
+            }
+            watcher->deleteLater();
+        });
+        watcher->setFuture(QtConcurrent::run([=]() { return columnRanks(values, type); }));
+    }
+    
+    QVector<int> searchedColumns() const {
+        // The first column of check and image lists isn't displayed as text.
+        const int first = m_allColumns && (m_model->isCheckable() || m_model->hasIcons()) ? 1 : 0;
+        const int last = m_allColumns ? m_model->columnCount() - 1 : 0;
+        QVector<int> columns;
+        for (int j = first; j <= last; ++j)
+            columns << j;
+        return columns;
+    }
+    
+    // Rows streaming in keep postponing the timers, but never past MaxWaitMs after the first
+    // change, so that a growing list is still filtered and sorted along the way.
+    void rescan() {
+        if (m_revision != m_model->revision() && !m_pendingQuery.isEmpty())
+            debounce(m_timer, m_scanWait);
+        if (m_rankRevision != m_model->revision() && m_rankedColumn >= 0)
+            debounce(m_rankTimer, m_rankWait);
+    }
+    
+    static void debounce(QTimer &timer, QElapsedTimer &wait) {
+        if (!timer.isActive() || !wait.isValid())
+            wait.start();
+        timer.start(int(qBound(qint64(0), MaxWaitMs - wait.elapsed(), qint64(DebounceMs))));
+    }
+    
+    void scan() {
+        const QString query = m_pendingQuery;
+        const int scanId = ++m_scanId;
+        if (query.isEmpty()) {
+            m_query.clear();
+            invalidateFilter();
+            return;
+        }
+        
+        const int revision = m_model->revision();
+        const bool refold = m_foldedRevision != revision;
+        QVector<QVector<QString> > columns = m_folded;
+        if (refold) {
+            columns.clear();
+            foreach (int column, searchedColumns())
+                columns << m_model->column(column);
+        }
+        QBitArray candidates;
+        if (!m_query.isEmpty() && query.startsWith(m_query) && m_revision == revision)
+            candidates = m_matches;
+        const int rowCount = m_model->rowCount();
+        
+        QFutureWatcher<Scan> *watcher = new QFutureWatcher<Scan>(this);
+        connect(watcher, &QFutureWatcher<Scan>::finished, this, [=]() {
+            if (scanId == m_scanId && revision == m_model->revision()) {
+                const Scan result = watcher->result();
+                m_folded = result.folded;
+                m_foldedRevision = revision;
+                m_matches = result.matches;
+                m_revision = revision;
+                m_query = query;
+                invalidateFilter();
+            }
+            watcher->deleteLater();
+        });
+        watcher->setFuture(QtConcurrent::run([=]() {
+            Scan result;
+            result.folded = columns;
+            if (refold) {
+                for (int j = 0; j < result.folded.count(); ++j) {
+                    QVector<QString> &column = result.folded[j];
+                    for (int i = 0; i < rowCount; ++i)
+                        column[i] = column.at(i).toCaseFolded();
+                }
+            }
+            result.matches = QBitArray(rowCount);
+            for (int i = 0; i < rowCount; ++i) {
+                if (!candidates.isEmpty() && !candidates.testBit(i))
+                    continue;
+                for (int j = 0; j < result.folded.count(); ++j) {
+                    if (result.folded.at(j).at(i).contains(query)) {
+                        result.matches.setBit(i);
+                        break;
+                    }
+                }
+            }
+            return result;
+        }));
+    }
+    
+    bool m_allColumns;
+    QVector<QVector<QString> > m_folded;
+    int m_foldedRevision;
+    QBitArray m_matches;
+    ListModel *m_model;
+    QCollator m_naturalCollator;
+    QString m_pendingQuery;
+    QString m_query;
+    int m_rankColumn;
+    int m_rankId;
+    int m_rankRevision;
+    QVector<int> m_ranks;
+    QTimer m_rankTimer;
+    SortType m_rankType;
+    QElapsedTimer m_rankWait;
+    int m_rankedColumn; // asked for by sort(), m_rankColumn is the one ranked last
+    Qt::SortOrder m_rankedOrder;
+    int m_revision;
+    int m_scanId;
+    QElapsedTimer m_scanWait;
+    QHash<int, SortType> m_sortTypes;
+    QCollator m_textCollator;
+    QTimer m_timer;
+};
+
+// End of "class ListFilter"
+
+/******************************************************************************
+ * class Coprocess
+ ******************************************************************************/
+
+static int readStdInRecords(const QByteArray &buffer, Guid::StdinFormat format, bool atEnd, QStringList &records,
+                            bool *invalid = NULL);
+
+// Command of --ok-coprocess, started once and sent each submission as a framed record on
+// its stdin. When there's a reply handler, every record the command prints back answers
+// the oldest submission, otherwise a submission is done once it's written to the pipe. At
+// most maxInFlight of them are in flight and up to MaxPending more are queued. A worker
+// dying with submissions in flight is started again and gets them back, unless it keeps
+// dying before getting through any. When the dialog is done with it, the worker gets its
+// stdin closed and is left to exit on its own, without blocking the GUI thread: a server
+// kills it after FinishMs, a guid exiting leaves it to finish the last submissions.
+class Coprocess : public QObject {
+public:
+    Coprocess(const QString &command, Guid::StdinFormat format, int maxInFlight, const QString &prefixErr,
+              QObject *parent = 0) : QObject(parent), m_failures(0), m_format(format),
+        m_maxInFlight(qMax(maxInFlight, 1)), m_prefixErr(prefixErr), m_stopped(false), m_written(0) {
+        m_arguments = command.split("<>");
+        m_program = m_arguments.takeFirst();
+        m_process = new QProcess(this);
+        m_process->setProcessChannelMode(QProcess::ForwardedErrorChannel);
+        connect(m_process, &QProcess::readyReadStandardOutput, this, [=]() { readReplies(); });
+        connect(m_process, &QProcess::bytesWritten, this, [=](qint64 bytes) { written(bytes); });
+        connect(m_process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this, [=]() {
+            workerDied();
+        });
+        connect(m_process, &QProcess::errorOccurred, this, [=](QProcess::ProcessError error) {
+            if (error == QProcess::FailedToStart)
+                stop(QString("--ok-coprocess failed to start %1").arg(m_program));
+        });
+    }
+    
+    ~Coprocess() { finish(); }
+    
+    void setReplyHandler(const std::function<void(const QString&)> &reply) { m_reply = reply; }
+    
+    void submit(const QString &values) {
+        if (m_stopped)
+            return;
+        if (m_pending.count() >= MaxPending) {
+            QOUT_ERR
+            qOutErr << m_prefixErr + "--ok-coprocess is too far behind, dropping a submission" << Qt::endl;
+            return;
+        }
+        m_pending.enqueue(values);
+        writePending();
+    }
+    
+    // Closes the stdin of the worker and lets it go: it's deleted once it exits, and killed
+    // if it's still running after FinishMs of event loop.
+    void finish() {
+        m_stopped = true;
+        if (!m_process)
+            return;
+        QProcess *process = m_process;
+        m_process = NULL;
+        process->disconnect(this);
+        if (process->state() == QProcess::NotRunning) {
+            delete process;
+            return;
+        }
+        process->setParent(NULL);
+        process->closeWriteChannel();
+        connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), process,
+                &QObject::deleteLater);
+        QTimer::singleShot(FinishMs, process, &QProcess::kill);
+    }
+    
+private:
+    enum { FinishMs = 2000, MaxFailures = 5, MaxPending = 1024, RestartMs = 500 };
+    
+    QByteArray frame(const QString &values) const {
+        if (m_format == Guid::Lines)
+            return values.toLocal8Bit() + '\n';
+        const QByteArray record = values.toUtf8();
+        if (m_format == Guid::NulDelimited)
+            return record + '\0';
+        QByteArray length(4, '\0');
+        qToBigEndian<quint32>(record.size(), length.data());
+        return length + record;
+    }
+    
+    void writePending() {
+        if (m_stopped || m_pending.isEmpty())
+            return;
+        if (m_process->state() == QProcess::NotRunning)
+            m_process->start(m_program, m_arguments); // writes are buffered until it's running
+        while (!m_pending.isEmpty() && m_inFlight.count() < m_maxInFlight) {
+            const QString values = m_pending.dequeue();
+            const QByteArray record = frame(values);
+            m_process->write(record);
+            m_inFlight.enqueue(values);
+            m_frameSizes.enqueue(record.size());
+        }
+    }
+    
+    // Without a reply handler, the submissions are done as their records reach the pipe.
+    void written(qint64 bytes) {
+        m_written += bytes;
+        while (!m_frameSizes.isEmpty() && m_written >= m_frameSizes.head()) {
+            m_written -= m_frameSizes.dequeue();
+            if (!m_reply && !m_inFlight.isEmpty()) {
+                m_failures = 0;
+                m_inFlight.dequeue();
+            }
+        }
+        if (!m_reply)
+            writePending();
+    }
+    
+    void readReplies() {
+        if (!m_reply) {
+            m_process->readAllStandardOutput(); // read only so that the pipe doesn't fill up
+            return;
+        }
+        m_replies += m_process->readAllStandardOutput();
+        QStringList records;
+        bool invalid = false;
+        m_replies.remove(0, readStdInRecords(m_replies, m_format, false, records, &invalid));
+        foreach (const QString &record, records) {
+            m_failures = 0;
+            if (!m_inFlight.isEmpty())
+                m_inFlight.dequeue();
+            m_reply(record);
+        }
+        if (invalid) {
+            stop("--ok-coprocess replied with a record length out of range, giving up");
+            return;
+        }
+        writePending();
+    }
+    
+    void workerDied() {
+        m_replies.clear();
+        m_frameSizes.clear();
+        m_written = 0;
+        if (m_stopped || m_inFlight.isEmpty())
+            return; // the next submission starts a new worker
+        if (++m_failures > MaxFailures) {
+            stop("--ok-coprocess keeps exiting before answering, giving up");
+            return;
+        }
+        while (!m_inFlight.isEmpty())
+            m_pending.prepend(m_inFlight.takeLast());
+        QTimer::singleShot(RestartMs, this, [=]() { writePending(); });
+    }
+    
+    void stop(const QString &message) {
+        QOUT_ERR
+        qOutErr << m_prefixErr + message << Qt::endl;
+        m_stopped = true;
+        m_pending.clear();
+        m_inFlight.clear();
+    }
+    
+    QStringList m_arguments;
+    int m_failures;
+    Guid::StdinFormat m_format;
+    QQueue<int> m_frameSizes; // of the records not entirely written yet
+    QQueue<QString> m_inFlight;
+    int m_maxInFlight;
+    QQueue<QString> m_pending;
+    QString m_prefixErr;
+    QProcess *m_process;
+    QString m_program;
+    QByteArray m_replies;
+    std::function<void(const QString&)> m_reply;
+    bool m_stopped;
+    qint64 m_written;
+};
+
+// End of "class Coprocess"
+
+/******************************************************************************
+ * class Notifier
+ ******************************************************************************/
+
+// Desktop notifications of --notification, sent without waiting for the bus. A single Notify
+// call is in flight at a time: a message arriving meanwhile waits for it and is replaced
+// by any newer one, so a chatty --listen producer updates one notification, through the id
+// returned by the last call, at the pace the daemon answers.
+class Notifier : public QObject {
+public:
+    Notifier(QObject *parent = 0) : QObject(parent), m_id(0), m_inFlight(false), m_queued(false), m_timeout(0) {}
+    
+    // The daemon is looked up once, and again after a failed call or forget(); without it,
+    // the caller falls back to its own dialog.
+    static bool isAvailable() {
+        if (s_available < 0)
+            s_available = QDBusConnection::sessionBus().interface() &&
+                QDBusConnection::sessionBus().interface()->isServiceRegistered("org.freedesktop.Notifications");
+        return s_available > 0;
+    }
+    
+    // The daemon may come and go between the requests of a server.
+    static void forget() { s_available = -1; }
+    
+    void notify(const QString &summary, const QString &body, const QVariantMap &hints, int timeout) {
+        m_summary = summary;
+        m_body = body;
+        m_hints = hints;
+        m_timeout = timeout;
+        m_queued = true;
+        if (!m_inFlight)
+            sendQueued();
+    }
+    
+    // Calls done once the last message has been answered, so that exiting doesn't drop it.
+    // done may delete the notifier, hence the call from the event loop of the application.
+    void finish(const std::function<void()> &done) {
+        if (m_inFlight)
+            m_finished << done;
+        else
+            QTimer::singleShot(0, qApp, done);
+    }
+    
+private:
+    void sendQueued() {
+        m_queued = false;
+        m_inFlight = true;
+        QDBusMessage message = QDBusMessage::createMethodCall("org.freedesktop.Notifications",
+                                                              "/org/freedesktop/Notifications",
+                                                              "org.freedesktop.Notifications", "Notify");
+        message << QString("Guid") << m_id << QString("dialog-information") << m_summary << m_body
+                << QStringList() /*actions*/ << m_hints << m_timeout;
+        QDBusPendingCallWatcher *watcher =
+            new QDBusPendingCallWatcher(QDBusConnection::sessionBus().asyncCall(message), this);
+        connect(watcher, &QDBusPendingCallWatcher::finished, this, [=]() {
+            QDBusPendingReply<uint> reply = *watcher;
+            if (!reply.isError())
+                m_id = reply.value();
+            else
+                forget();
+            watcher->deleteLater();
+            m_inFlight = false;
+            if (m_queued) {
+                sendQueued();
+                return;
+            }
+            foreach (const std::function<void()> &done, m_finished)
+                QTimer::singleShot(0, qApp, done);
+            m_finished.clear();
+        });
+    }
+    
+    QString m_body;
+    QList<std::function<void()> > m_finished;
+    QVariantMap m_hints;
+    uint m_id;
+    bool m_inFlight;
+    bool m_queued;
+    QString m_summary;
+    int m_timeout;
+    static int s_available; // -1 until looked up
+};
+
+int Notifier::s_available = -1;
+
+// End of "class Notifier"
+
+/******************************************************************************
+ * class FileWatcher
+ ******************************************************************************/
+
+// Invokes receiver's member(QString) once per burst of changes of a watched file, and at
+// least every MaxWaitMs while a burst goes on (a file written continuously). The
+// parent directory is watched as well, so files replaced by an atomic rename are picked
+// up again as soon as they are back; nothing blocks while waiting for them.
+class FileWatcher : public QFileSystemWatcher {
+public:
+    FileWatcher(QObject *receiver, const char *member, QObject *parent = 0) : QFileSystemWatcher(parent),
+        m_member(member), m_receiver(receiver) {
+        connect(this, &QFileSystemWatcher::fileChanged, [=](const QString &path) {
+            schedule(path, DebounceMs);
+        });
+        connect(this, &QFileSystemWatcher::directoryChanged, [=](const QString &dir) {
+            foreach (const QString &path, m_dirPaths.values(dir)) {
+                if (!files().contains(path) && QFile::exists(path))
+                    schedule(path, DebounceMs);
+            }
+        });
+    }
+    
+    void watch(const QString &path) {
+        const QString dir = QFileInfo(path).absolutePath();
+        if (m_dirPaths.contains(dir, path))
+            return;
+        m_dirPaths.insert(dir, path);
+        addPath(path);
+        if (!directories().contains(dir))
+            addPath(dir);
+    }
+    
+private:
+    enum { DebounceMs = 50, MaxWaitMs = 250, RetryMs = 20, MaxRetries = 25 };
+    
+    void schedule(const QString &path, int msec) {
+        if (TraceSpan::isOn() && !m_changedAt.contains(path))
+            m_changedAt.insert(path, TraceSpan::now());
+        QTimer *timer = m_timers.value(path);
+        if (!timer) {
+            timer = new QTimer(this);
+            timer->setSingleShot(true);
+            connect(timer, &QTimer::timeout, [=]() { fire(path); });
+            m_timers.insert(path, timer);
+        }
+        if (!m_burstStarts.contains(path))
+            m_burstStarts[path].start();
+        // Restarting the timer swallows bursts, but not past the first change plus MaxWaitMs.
+        const qint64 waited = m_burstStarts.value(path).elapsed();
+        timer->start(int(qBound(qint64(0), MaxWaitMs - waited, qint64(msec))));
+    }
+    
+    void fire(const QString &path) {
+        m_burstStarts.remove(path);
+        if (!QFile::exists(path)) {
+            // Some editors delete the file before writing the new one. The directory
+            // watch reports it when it's back, but keep polling a bit in case the
+            // directory can't be watched.
+            if (++m_retries[path] < MaxRetries)
+                schedule(path, RetryMs);
+            else
+                m_retries.remove(path);
+            return;
+        }
+        m_retries.remove(path);
+        if (!files().contains(path))
+            addPath(path);
+        QMetaObject::invokeMethod(m_receiver, m_member.constData(), Q_ARG(QString, path));
+        // From the first change of the burst to the end of the reload, or of its start
+        // when the content is loaded in the background.
+        if (m_changedAt.contains(path))
+            TraceSpan::write("file change", m_changedAt.take(path), TraceSpan::member("path", path));
+    }
+    
+    QHash<QString, QElapsedTimer> m_burstStarts;
+    QHash<QString, qint64> m_changedAt;
+    QMultiHash<QString, QString> m_dirPaths;
+    QByteArray m_member;
+    QObject *m_receiver;
+    QHash<QString, int> m_retries;
+    QHash<QString, QTimer*> m_timers;
+};
+
+// End of "class FileWatcher"
+
+/******************************************************************************
+ * class FooterBox
+ ******************************************************************************/
+
+// Group box of the forms footer, newest entry first. Entries are kept in a ring buffer as
+// large as the number of entries displayed, so a bulk update only writes that many slots,
+// and the labels, one per displayed entry, are created once and then only get new texts.
+class FooterBox : public QGroupBox {
+public:
+    FooterBox(const QString &title, QWidget *parent = 0) : QGroupBox(title, parent), m_count(0), m_head(0) {}
+    
+    // newEntries are given newest first.
+    void addEntries(const QStringList &newEntries, int capacity) {
+        setCapacity(qMax(capacity, 1));
+        for (int i = qMin(newEntries.count(), m_entries.count()) - 1; i >= 0; --i) {
+            m_head = (m_head + 1) % m_entries.count();
+            m_entries[m_head] = newEntries.at(i);
+            m_count = qMin(m_count + 1, m_entries.count());
+        }
+        
+        QFormLayout *footerLayout = static_cast<QFormLayout*>(layout());
+        while (m_labels.count() > m_count) {
+            footerLayout->removeRow(m_labels.count() - 1);
+            m_labels.removeLast();
+        }
+        while (m_labels.count() < m_count) {
+            QLabel *label = new QLabel();
+            label->setWordWrap(true);
+            label->setTextInteractionFlags(label->textInteractionFlags()|Qt::TextSelectableByMouse);
+            footerLayout->addRow(label);
+            m_labels << label;
+        }
+        for (int i = 0; i < m_count; ++i)
+            m_labels.at(i)->setText(entry(i));
+    }
+    
+private:
+    // i = 0 is the newest entry.
+    const QString &entry(int i) const {
+        return m_entries.at((m_head - i + m_entries.count()) % m_entries.count());
+    }
+    
+    void setCapacity(int capacity) {
+        if (capacity == m_entries.count())
+            return;
+        m_count = qMin(m_count, capacity);
+        QVector<QString> entries(capacity);
+        for (int i = 0; i < m_count; ++i)
+            entries[m_count - 1 - i] = entry(i);
+        m_entries = entries;
+        m_head = (m_count - 1 + capacity) % capacity;
+    }
+    
+    int m_count;
+    QVector<QString> m_entries;
+    int m_head;
+    QList<QLabel*> m_labels;
+};
+
+// End of "class FooterBox"
+
+/******************************************************************************
+ * class OutputWriter
+ ******************************************************************************/
+
+// Prints the values of a result as they are produced instead of joining them first. They
+// are encoded into one large buffer handed to stdout whenever it fills up and flushed
+// once by finish(), either joined by the separator and ended by a newline or each one
+// ended by a NUL byte (--output-format=nul).
+class OutputWriter {
+public:
+    OutputWriter(const QString &prefix, const QString &separator, bool nulTerminated) :
+        m_count(0), m_nulTerminated(nulTerminated), m_separator(separator) {
+        m_buffer.reserve(BufferSize);
+        m_buffer += prefix.toUtf8();
+    }
+    
+    void add(const QString &value) {
+        append(nextSeparator() + value);
+        endValue();
+    }
+    
+    // What goes before the next value: nothing before the first one or with NUL bytes.
+    QString nextSeparator() const { return m_count > 0 && !m_nulTerminated ? m_separator : QString(); }
+    
+    // Text of the current value, which can be given in several pieces.
+    void append(const QString &text) {
+        m_buffer += text.toUtf8();
+        if (m_buffer.size() >= BufferSize)
+            write();
+    }
+    
+    void endValue() {
+        if (m_nulTerminated)
+            m_buffer += '\0';
+        ++m_count;
+    }
+    
+    void finish() {
+        if (!m_nulTerminated)
+            m_buffer += '\n';
+        write();
+        fflush(stdout);
+    }
+    
+private:
+    enum { BufferSize = 1 << 20 };
+    
+    void write() {
+        fwrite(m_buffer.constData(), 1, m_buffer.size(), stdout);
+        m_buffer.resize(0); // the reserved capacity is kept
+    }
+    
+    QByteArray m_buffer;
+    int m_count;
+    bool m_nulTerminated;
+    QString m_separator;
+};
+
+// End of "class OutputWriter"
+
+/******************************************************************************
+ * class ValueText
+ ******************************************************************************/
+
+// Text of a forms value, either kept in a string or written to the output piece by piece,
+// so that a large list goes out row after row. A widget adds the separator and the name
+// that go before its value to the pending text, which is only written along with the
+// next append(): a widget that turns out to have no value leaves nothing behind.
+class ValueText {
+public:
+    explicit ValueText(OutputWriter *out = NULL) : m_out(out), m_size(0) {}
+    
+    void append(const QString &text) {
+        const QString piece = m_pending + text;
+        m_pending.clear();
+        m_size += piece.size();
+        if (m_out)
+            m_out->append(piece);
+        else
+            m_text += piece;
+    }
+    
+    QString pending() const { return m_pending; }
+    void setPending(const QString &text) { m_pending = text; }
+    
+    // Length of the text appended so far, the pending text left out.
+    qint64 size() const { return m_size; }
+    // Empty when the text is written to the output.
+    QString text() const { return m_text; }
+    
+private:
+    OutputWriter *m_out;
+    QString m_pending;
+    qint64 m_size;
+    QString m_text;
+};
+
+// End of "class ValueText"
+
+/******************************************************************************
+ * class PagedText
+ ******************************************************************************/
+
+// Read-only viewer of --text-info --paged: the file is mapped, not read, and only the lines
+// in sight are decoded. The offsets of the lines are found in the background, chunk after
+// chunk, so the top of the file is there at once and the scroll range grows until the end
+// is reached. find() scans the mapped bytes on a worker thread as well. A file truncated
+// while it's shown loses its end: the bytes past its current size are never touched, as
+// reading them would kill guid with SIGBUS.
+class PagedText : public QAbstractScrollArea {
+public:
+    enum { AutoSize = 64 << 20 }; // files from this size are paged without --paged
+    
+    PagedText(QWidget *parent = 0) : QAbstractScrollArea(parent), m_data(NULL), m_indexed(false),
+        m_matchLength(0), m_matchOffset(-1), m_matchPending(false), m_maxWidth(0), m_searchId(0), m_size(0) {
+        setFocusPolicy(Qt::StrongFocus);
+        verticalScrollBar()->setSingleStep(1);
+    }
+    
+    ~PagedText() {
+        m_cancel.storeRelaxed(1);
+        m_index.waitForFinished();
+        m_search.waitForFinished();
+    }
+    
+    bool open(const QString &filename) {
+        m_file.setFileName(filename);
+        if (!m_file.open(QIODevice::ReadOnly))
+            return false;
+        m_size = m_file.size();
+        if (m_size > 0 && !(m_data = m_file.map(0, m_size)))
+            return false;
+        if (m_size > 0)
+            m_lines << 0;
+        m_index = QtConcurrent::run([=]() { indexLines(); });
+        return true;
+    }
+    
+    // Selects the next occurrence of text, from the current match or the top of the page,
+    // going on from the start of the file when the end is reached.
+    void find(const QString &text, const std::function<void(bool)> &found) {
+        const QByteArray needle = text.toUtf8();
+        if (needle.isEmpty() || m_size == 0)
+            return;
+        const qint64 from = m_matchOffset >= 0 ? m_matchOffset + 1 : lineStart(verticalScrollBar()->value());
+        const int searchId = ++m_searchId;
+        m_search.waitForFinished(); // a previous search stops early once it's outdated
+        m_search = QtConcurrent::run([=]() {
+            qint64 offset = search(needle, from, m_size, searchId);
+            if (offset < 0)
+                offset = search(needle, 0, qMin(from + needle.size() - 1, m_size), searchId);
+            QMetaObject::invokeMethod(this, [=]() {
+                if (searchId != m_searchId)
+                    return;
+                if (offset >= 0) {
+                    m_matchOffset = offset;
+                    m_matchLength = needle.size();
+                    m_matchPending = true;
+                    showMatch();
+                }
+                found(offset >= 0);
+            }, Qt::QueuedConnection);
+        });
+    }
+    
+protected:
+    void keyPressEvent(QKeyEvent *event) {
+        if (event->matches(QKeySequence::MoveToStartOfDocument))
+            verticalScrollBar()->setValue(0);
+        else if (event->matches(QKeySequence::MoveToEndOfDocument))
+            verticalScrollBar()->setValue(verticalScrollBar()->maximum());
+        else
+            QAbstractScrollArea::keyPressEvent(event);
+    }
+    
+    void paintEvent(QPaintEvent *) {
+        QPainter painter(viewport());
+        painter.setFont(font());
+        painter.setPen(viewport()->palette().color(QPalette::Text));
+        const QFontMetrics fm(font());
+        const int x = Margin - horizontalScrollBar()->value();
+        const int count = lineCount();
+        int y = Margin;
+        const qint64 available = currentSize();
+        for (int i = verticalScrollBar()->value(); i < count && y < viewport()->height(); ++i) {
+            const qint64 start = lineStart(i);
+            if (start >= available)
+                break;
+            const QString raw = lineText(i, available);
+            const QString text = expandTabs(raw);
+            if (m_matchOffset >= start && m_matchOffset < lineStart(i + 1) &&
+                m_matchOffset + m_matchLength <= available) {
+                // Columns are counted in the text as painted, tabs expanded.
+                const int rawColumn = decode(start, m_matchOffset).length();
+                const int rawLength = decode(m_matchOffset, m_matchOffset + m_matchLength).length();
+                const int column = expandTabs(raw.left(rawColumn)).length();
+                const int length = expandTabs(raw.left(rawColumn + rawLength)).length() - column;
+                const int left = x + fm.horizontalAdvance(text.left(column));
+                const QRect match(left, y, fm.horizontalAdvance(text.mid(column, length)), fm.height());
+                painter.fillRect(match, palette().brush(QPalette::Highlight));
+            }
+            painter.drawText(x, y + fm.ascent(), text);
+            m_maxWidth = qMax(m_maxWidth, fm.horizontalAdvance(text));
+            y += fm.lineSpacing();
+        }
+        updateScrollBars();
+    }
+    
+    void resizeEvent(QResizeEvent *) {
+        updateScrollBars();
+    }
+    
+private:
+    enum { ChunkSize = 4 << 20, Margin = 4, MaxLineLength = 64 << 10, TabWidth = 8 };
+    
+    void appendLines(const QVector<qint64> &lines, bool indexed) {
+        m_lines << lines;
+        m_indexed = indexed;
+        updateScrollBars();
+        if (m_matchPending)
+            showMatch();
+        viewport()->update();
+    }
+    
+    // Size of the file now, at most the mapped size.
+    qint64 currentSize() const {
+        #ifdef Q_OS_UNIX
+            struct stat info;
+            if (::fstat(m_file.handle(), &info) == 0)
+                return qMin(qint64(info.st_size), m_size);
+        #endif
+        return m_size;
+    }
+    
+    QString decode(qint64 start, qint64 end) const {
+        return QString::fromUtf8(reinterpret_cast<const char*>(m_data) + start, end - start);
+    }
+    
+    static QString expandTabs(QString text) {
+        for (int i = text.indexOf('\t'); i >= 0; i = text.indexOf('\t', i)) {
+            const int spaces = TabWidth - i % TabWidth;
+            text.replace(i, 1, QString(spaces, ' '));
+            i += spaces;
+        }
+        return text;
+    }
+    
+    // Runs on the pool: the offsets are handed over with one queued call per chunk. A file
+    // cut meanwhile is indexed up to its current end.
+    void indexLines() {
+        for (qint64 chunk = 0; chunk < m_size && !m_cancel.loadRelaxed(); chunk += ChunkSize) {
+            const qint64 available = currentSize();
+            if (available <= chunk) {
+                QMetaObject::invokeMethod(this, [=]() { appendLines(QVector<qint64>(), true); }, Qt::QueuedConnection);
+                return;
+            }
+            const qint64 end = qMin(chunk + ChunkSize, available);
+            const char *data = reinterpret_cast<const char*>(m_data);
+            QVector<qint64> lines;
+            for (const char *p = data + chunk; (p = static_cast<const char*>(memchr(p, '\n', data + end - p)));) {
+                if (++p - data < m_size)
+                    lines << p - data;
+            }
+            const bool indexed = end == available;
+            QMetaObject::invokeMethod(this, [=]() { appendLines(lines, indexed); }, Qt::QueuedConnection);
+        }
+    }
+    
+    // The last known line may still be cut by the end of a chunk until the indexing is done.
+    int lineCount() const { return m_indexed ? m_lines.count() : qMax(m_lines.count() - 1, 0); }
+    qint64 lineStart(int line) const { return line < m_lines.count() ? m_lines.at(line) : m_size; }
+    
+    // Tabs aren't expanded yet. Long lines are cut at MaxLineLength, before a whole UTF-8
+    // sequence.
+    QString lineText(int line, qint64 available) const {
+        qint64 end = qMin(lineStart(line + 1), available);
+        const qint64 start = lineStart(line);
+        while (end > start && (m_data[end - 1] == '\n' || m_data[end - 1] == '\r'))
+            --end;
+        if (end > start + MaxLineLength) {
+            end = start + MaxLineLength;
+            while (end > start && (m_data[end] & 0xC0) == 0x80)
+                --end;
+        }
+        return decode(start, end);
+    }
+    
+    // QByteArray works with int sizes, hence the search by chunks overlapping by the needle.
+    qint64 search(const QByteArray &needle, qint64 from, qint64 to, int searchId) const {
+        const qint64 step = ChunkSize - needle.size();
+        for (qint64 chunk = from; chunk < to && step > 0; chunk += step) {
+            if (m_cancel.loadRelaxed() || searchId != m_searchId.loadRelaxed())
+                return -1;
+            const qint64 length = qMin(qint64(ChunkSize), currentSize() - chunk);
+            if (length < needle.size())
+                return -1;
+            const QByteArray data = QByteArray::fromRawData(reinterpret_cast<const char*>(m_data) + chunk, length);
+            const int i = data.indexOf(needle);
+            if (i >= 0 && chunk + i < to)
+                return chunk + i;
+            if (i >= 0 || chunk + length >= m_size)
+                return -1;
+        }
+        return -1;
+    }
+    
+    // A match beyond the lines indexed so far is shown once they get there.
+    void showMatch() {
+        viewport()->update();
+        if (m_matchOffset >= lineStart(lineCount()))
+            return;
+        m_matchPending = false;
+        const int line = std::upper_bound(m_lines.constBegin(), m_lines.constEnd(), m_matchOffset) -
+                         m_lines.constBegin() - 1;
+        const QScrollBar *bar = verticalScrollBar();
+        if (line < bar->value() || line >= bar->value() + bar->pageStep())
+            verticalScrollBar()->setValue(line - bar->pageStep() / 2);
+    }
+    
+    void updateScrollBars() {
+        const QFontMetrics fm(font());
+        const int pageLines = qMax((viewport()->height() - Margin) / fm.lineSpacing(), 1);
+        verticalScrollBar()->setPageStep(pageLines);
+        verticalScrollBar()->setRange(0, qMax(lineCount() - pageLines, 0));
+        horizontalScrollBar()->setPageStep(viewport()->width());
+        horizontalScrollBar()->setSingleStep(fm.averageCharWidth());
+        horizontalScrollBar()->setRange(0, qMax(m_maxWidth + 2 * Margin - viewport()->width(), 0));
+    }
+    
+    QAtomicInt m_cancel;
+    const uchar *m_data;
+    QFile m_file;
+    QFuture<void> m_index;
+    bool m_indexed;
+    QVector<qint64> m_lines;
+    int m_matchLength;
+    qint64 m_matchOffset;
+    bool m_matchPending;
+    int m_maxWidth;
+    QFuture<void> m_search;
+    QAtomicInt m_searchId;
+    qint64 m_size;
+};
+
+// End of "class PagedText"
+
+/******************************************************************************
+ * typedef
+ ******************************************************************************/
+
+typedef QPair<QString, QString> Help;
+typedef QList<Help> HelpList;
+typedef QPair<QString, HelpList> CategoryHelp;
+typedef QMap<QString, CategoryHelp> HelpDict;
+typedef void (*WidgetSettingSetter)(WidgetSettings &ws, const QString &setting);
+
+// End of "typedef"
+
+/******************************************************************************
+ * static variables
+ ******************************************************************************/
+
+static QFile *gs_stdin = 0;
+
+// Marker files parsed once for all the --add-text labels of the dialog, an entry is
+// dropped when the watcher reports a change.
+static QHash<QString, MarkerFile> gs_markerFiles;
+
+#define MARKER_PROPERTIES(_PREFIX_) { _PREFIX_ "1", _PREFIX_ "2", _PREFIX_ "3", _PREFIX_ "4", \
+    _PREFIX_ "5", _PREFIX_ "6", _PREFIX_ "7", _PREFIX_ "8", _PREFIX_ "9" }
+static const char *const gs_defMarkerValProps[9] = MARKER_PROPERTIES("guid_text_def_marker_val_");
+static const char *const gs_markerFileProps[9] = MARKER_PROPERTIES("guid_text_monitor_marker_file_");
+static const char *const gs_markerVarNameProps[9] = MARKER_PROPERTIES("guid_text_monitor_var_name_");
+#undef MARKER_PROPERTIES
+
+// Dialog widgets by watched file and by class (superclasses included), the slots use them
+// instead of walking the widget tree and comparing properties on every event. The files of
+// each widget are indexed too, so that a widget going away costs its own entries only.
+static QMultiHash<QString, QWidget*> gs_fileWidgets;
+static QMultiHash<const QMetaObject*, QWidget*> gs_typeWidgets;
+static QMultiHash<QWidget*, QString> gs_widgetFiles;
+
+// Rasterized QR codes by size, error correction level and text, least recently used ones
+// are dropped first. Kept across requests in server mode.
+static QCache<QString, QImage> gs_qrCodeImages(32);
+
+#ifdef Q_OS_UNIX
+    // Parent of the process that asked for the dialog, which is a client in server mode.
+    static pid_t gs_parentPid = 0;
+    
+    // What each client request changes and the server gets back after it.
+    static QTextCodec *gs_serverCodec = NULL;
+    static QByteArray gs_serverDirectory;
+    static QList<QByteArray> gs_serverEnvironment;
+    
+    // Whether the trace was started for the current client request.
+    static bool gs_requestTrace = false;
+#endif
+
+// End of "static variables"
+
+/******************************************************************************
+ * static functions
+ ******************************************************************************/
+
+static void indexWidgets(QWidget *root)
+{
+    foreach (QWidget *w, root->findChildren<QWidget*>()) {
+        const QMetaObject *leaf = w->metaObject();
+        if (gs_typeWidgets.contains(leaf, w))
+            continue;
+        for (const QMetaObject *mo = leaf; mo && mo != &QObject::staticMetaObject; mo = mo->superClass())
+            gs_typeWidgets.insert(mo, w);
+        QObject::connect(w, &QObject::destroyed, [=]() {
+            for (const QMetaObject *mo = leaf; mo && mo != &QObject::staticMetaObject; mo = mo->superClass())
+                gs_typeWidgets.remove(mo, w);
+        });
+    }
+}
+
+template <class T> static QList<T*> dialogWidgets()
+{
+    QList<T*> widgets;
+    foreach (QWidget *w, gs_typeWidgets.values(&T::staticMetaObject))
+        widgets << static_cast<T*>(w);
+    return widgets;
+}
+
+template <class T> static T *dialogWidget()
+{
+    QList<T*> widgets = dialogWidgets<T>();
+    return widgets.isEmpty() ? NULL : widgets.last(); // values() lists the last inserted first
+}
+
+template <class T> static QList<T*> fileWidgets(const QString &filePath)
+{
+    QList<T*> widgets;
+    foreach (QWidget *w, gs_fileWidgets.values(filePath)) {
+        if (T *t = qobject_cast<T*>(w))
+            widgets << t;
+    }
+    return widgets;
+}
+
+// The marker file parsed for filePath goes with its last subscriber.
+static void watchFile(FileWatcher *watcher, const QString &filePath, QWidget *subscriber)
+{
+    if (!gs_widgetFiles.contains(subscriber)) {
+        QObject::connect(subscriber, &QObject::destroyed, [=]() {
+            foreach (const QString &file, gs_widgetFiles.values(subscriber)) {
+                gs_fileWidgets.remove(file, subscriber);
+                if (!gs_fileWidgets.contains(file))
+                    gs_markerFiles.remove(file);
+            }
+            gs_widgetFiles.remove(subscriber);
+        });
+    }
+    if (!gs_widgetFiles.contains(subscriber, filePath)) {
+        gs_widgetFiles.insert(subscriber, filePath);
+        gs_fileWidgets.insert(filePath, subscriber);
+    }
+    watcher->watch(filePath);
+}
+
+// Appends the complete records at the start of buffer and returns the number of bytes they
+// take. Each record is decoded once, straight from the buffer. At the end of the input an
+// unterminated last line or NUL-delimited record is complete too. A length prefix above
+// MaxStdinRecord can't be right, the parsing stops there and sets invalid.
+static int readStdInRecords(const QByteArray &buffer, Guid::StdinFormat format, bool atEnd, QStringList &records,
+                            bool *invalid)
+{
+    enum { MaxStdinRecord = 64 << 20 };
+    const char *data = buffer.constData();
+    const int size = buffer.size();
+    int pos = 0;
+    
+    if (format == Guid::LengthPrefixed) {
+        while (size - pos >= 4) {
+            const quint32 length = qFromBigEndian<quint32>(data + pos);
+            if (length > MaxStdinRecord) {
+                if (invalid)
+                    *invalid = true;
+                break;
+            }
+            if (length > quint32(size - pos - 4))
+                break;
+            records << QString::fromUtf8(data + pos + 4, length);
+            pos += 4 + length;
+        }
+        return pos;
+    }
+    
+    const char delimiter = format == Guid::NulDelimited ? '\0' : '\n';
+    while (pos < size) {
+        const char *end = static_cast<const char*>(memchr(data + pos, delimiter, size - pos));
+        if (!end && !atEnd)
+            break;
+        const int length = end ? int(end - data) - pos : size - pos;
+        if (format == Guid::NulDelimited)
+            records << QString::fromUtf8(data + pos, length);
+        else
+            records << QString::fromLocal8Bit(data + pos, length);
+        pos += end ? length + 1 : length;
+    }
+    return pos;
+}
+
+// Only the last label and the last percentage of a batch are visible anyway. value is -1
+// when there's no percentage.
+static void readProgressLines(const QStringList &lines, QString &label, bool &hasLabel, int &value)
+{
+    hasLabel = false;
+    value = -1;
+    bool ok;
+    foreach (const QString &line, lines) {
+        if (line.startsWith('#')) {
+            label = line.mid(1);
+            hasLabel = true;
+        } else {
+            static const QRegularExpression nondigit("[^0-9]");
+            int u = line.section(nondigit,0,0).toInt(&ok);
+            if (ok)
+                value = qMin(100,u);
+        }
+    }
+}
+
+// The time remaining is estimated from the first update of holder and shown as the
+// tooltip of widgets.
+static void updateProgressEta(QObject *holder, int value, const QList<QWidget*> &widgets)
+{
+    QDateTime starttime = holder->property("guid_eta_start").toDateTime();
+    if (starttime.isNull()) {
+        holder->setProperty("guid_eta_start", QDateTime::currentDateTime());
+    } else if (value > 0) {
+        const qint64 secs = starttime.secsTo(QDateTime::currentDateTime());
+        QString eta = QTime(0,0,0).addSecs(100 * secs / value - secs).toString();
+        foreach (QWidget *w, widgets)
+            w->setToolTip(eta);
+    }
+}
+
+static ListModel *listModel(const QTreeView *tv)
+{
+    if (!tv)
+        return NULL;
+    QAbstractItemModel *model = tv->model();
+    if (QAbstractProxyModel *proxy = qobject_cast<QAbstractProxyModel*>(model))
+        model = proxy->sourceModel();
+    return dynamic_cast<ListModel*>(model);
+}
+
+// Row of the ListModel shown at index of the view, they differ when the list is filtered.
+static int listModelRow(const QTreeView *tv, const QModelIndex &index)
+{
+    if (QAbstractProxyModel *proxy = qobject_cast<QAbstractProxyModel*>(tv->model()))
+        return proxy->mapToSource(index).row();
+    return index.row();
+}
+
+static QModelIndex listViewIndex(const QTreeView *tv, const QModelIndex &sourceIndex)
+{
+    if (QAbstractProxyModel *proxy = qobject_cast<QAbstractProxyModel*>(tv->model()))
+        return proxy->mapFromSource(sourceIndex);
+    return sourceIndex;
+}
+
+// Model rows to print, all of them or the selected ones. They come in the order of the
+// values given unless --print-order=view is used: the rows are then printed as sorted in
+// the view, and the rows filtered out come last.
+static QList<int> listOutputRows(const QTreeView *tv, bool allRows)
+{
+    const ListModel *model = listModel(tv);
+    QList<int> rows;
+    if (allRows) {
+        for (int i = 0; i < model->rowCount(); ++i)
+            rows << i;
+    } else {
+        foreach (const QModelIndex &index, tv->selectionModel()->selectedRows())
+            rows << listModelRow(tv, index);
+    }
+    
+    if (tv->property("guid_list_print_order").toString() != "view") {
+        std::sort(rows.begin(), rows.end());
+        return rows;
+    }
+    QVector<int> position(model->rowCount(), INT_MAX);
+    for (int i = 0; i < tv->model()->rowCount(); ++i)
+        position[listModelRow(tv, tv->model()->index(i, 0))] = i;
+    std::stable_sort(rows.begin(), rows.end(), [&](int a, int b) { return position.at(a) < position.at(b); });
+    return rows;
+}
+
+// Puts a ListFilter between the view and its ListModel, unless there's one already. The
+// selection and the current row are kept.
+static ListFilter *listFilter(QTreeView *tv, bool allColumns)
+{
+    if (ListFilter *proxy = dynamic_cast<ListFilter*>(tv->model()))
+        return proxy;
+    
+    ListFilter *proxy = new ListFilter(listModel(tv), allColumns, tv);
+    const QStringList types = tv->property("guid_list_column_types").toStringList();
+    for (int j = 0; j < types.count(); ++j) {
+        ListFilter::SortType type;
+        if (ListFilter::sortTypeFromName(types.at(j), type))
+            proxy->setSortType(j, type);
+    }
+    const QModelIndexList selected = tv->selectionModel()->selectedRows();
+    const QModelIndex current = tv->currentIndex();
+    tv->setModel(proxy);
+    QItemSelection selection;
+    foreach (const QModelIndex &index, selected)
+        selection.select(proxy->mapFromSource(index), proxy->mapFromSource(index));
+    tv->selectionModel()->select(selection, QItemSelectionModel::Select | QItemSelectionModel::Rows);
+    if (current.isValid())
+        tv->selectionModel()->setCurrentIndex(proxy->mapFromSource(current), QItemSelectionModel::NoUpdate);
+    return proxy;
+}
+
+// Clicking a header sorts the rows, which starts unsorted. The view shows the model itself
+// until the first click or the first search, which puts the ListFilter in.
+static void setListSorting(QTreeView *tv, bool allColumns = false, QLineEdit *filter = NULL)
+{
+    tv->header()->setSectionsClickable(true);
+    QObject::connect(tv->header(), &QHeaderView::sectionClicked, tv, [=](int column) {
+        if (tv->isSortingEnabled())
+            return;
+        listFilter(tv, allColumns);
+        tv->header()->setSortIndicator(column, Qt::AscendingOrder);
+        tv->setSortingEnabled(true); // sorts by the indicator
+    });
+    if (filter) {
+        QObject::connect(filter, &QLineEdit::textChanged, tv, [=](const QString &query) {
+            listFilter(tv, allColumns)->setQuery(query);
+        });
+    }
+}
+
+// Rows have uniform heights, and thus cost one size hint whatever their count, until a value
+// of the model spans several lines.
+static void setUniformRowHeights(QTreeView *tv, ListModel *model)
+{
+    auto update = [=]() { tv->setUniformRowHeights(!model->hasMultiLineValues()); };
+    update();
+    QObject::connect(model, &QAbstractItemModel::rowsInserted, tv, update);
+    QObject::connect(model, &QAbstractItemModel::dataChanged, tv, update);
+    QObject::connect(model, &QAbstractItemModel::modelReset, tv, update);
+}
+
+// With uniform row heights, the rows cost one size hint whatever their count. Otherwise the
+// rows are only measured until the height is past maxHeight, which is all the callers need
+// to know.
+static QSize getListViewSize(QTreeView *tv, int maxHeight = INT_MAX)
+{
+    qint64 height = 2 * tv->frameWidth();
+    if (!tv->isHeaderHidden())
+        height += tv->header()->sizeHint().height();
+    
+    QAbstractItemModel *model = tv->model();
+    if (tv->uniformRowHeights()) {
+        if (model->rowCount() > 0)
+            height += qint64(tv->sizeHintForRow(0)) * model->rowCount();
+    } else {
+        for (int i = 0; i < model->rowCount() && height <= maxHeight; ++i)
+            height += tv->visualRect(model->index(i, 0)).height();
+    }
+    
+    return QSize(tv->header()->length() + 2 * tv->frameWidth(), int(qMin<qint64>(height, INT_MAX)));
+}
+
+static QStringList addColumnToListValues(QStringList values, QString addValue, int nbColumns)
+{
+    QStringList result;
+    
+    if (!addValue.isEmpty()) {
+        int moduloComp = nbColumns - 1;
+        if (moduloComp <= 0)
+            moduloComp = 1;
+        int i = 0;
+        foreach(QString v, values) {
+            if (i % moduloComp == 0) {
+                result << addValue;
+            }
+            result << v;
+            i++;
+        }
+    } else {
+        result = values;
+    }
+    
+    return result;
+}
+
+static void addItems(QTreeView *tv, QStringList &values)
+{
+    if (ListModel *model = listModel(tv))
+        model->appendValues(values);
+}
+
+static void setCheckColumn(QTreeView *tv, const QString &selectionType)
+{
+    if (ListModel *model = listModel(tv)) {
+        model->setCheckable(selectionType == "checklist" || selectionType == "radiolist");
+        if (model->isCheckable())
+            tv->setItemDelegateForColumn(0, new CheckColumn(selectionType == "radiolist", tv));
+    }
+}
+
+static void buildFormsList(QTreeView **tree, GList &list, QStringList &columns, bool &showHeader,
+                           Qt::ItemFlags &flags, int &height)
+{
+    QTreeView *tw = *tree;
+
+    if (!tw)
+        return;
+    
+    tw->setRootIsDecorated(false);
+    int columnCount = columns.count();
+    tw->setHeaderHidden(!showHeader);
+    if (!columnCount)
+        columnCount = 1;
+    
+    ListModel *model = listModel(tw);
+    model->setColumnCount(columnCount);
+    model->setHeaderLabels(columns);
+    
+    list.val = addColumnToListValues(list.val, list.addValue, columnCount);
+    QString selectionType = tw->property("guid_list_selection_type").toString();
+    
+    setCheckColumn(tw, selectionType);
+    model->setItemFlags(flags);
+    addItems(tw, list.val);
+
+    for (int i = 0; i < columns.count(); ++i)
+        tw->resizeColumnToContents(i);
+
+    if (!selectionType.isEmpty())
+        tw->header()->setSectionResizeMode(0, QHeaderView::Fixed);
+
+    tw->setStyleSheet(QTREEWIDGET_STYLE);
+
+    if (height >= 0) {
+        QSizePolicy twSizePolicy = tw->sizePolicy();
+        twSizePolicy.setVerticalPolicy(QSizePolicy::Fixed);
+        tw->setSizePolicy(twSizePolicy);
+        if (height < getListViewSize(tw, height).height())
+            tw->setFixedHeight(height);
+    }
+    
+    int roColumnNumber = tw->property("guid_list_read_only_column").toInt();
+    roColumnNumber = roColumnNumber - 1;
+    if (roColumnNumber >= 0 && roColumnNumber < columns.count() && !(roColumnNumber == 0 && model->isCheckable()))
+        tw->setItemDelegateForColumn(roColumnNumber, new ReadOnlyColumn(tw));
+    
+    if (showHeader)
+        setListSorting(tw);
+
+    list = GList();
+    columns.clear();
+    showHeader = false;
+    flags = Qt::NoItemFlags;
+    height = -1;
+    *tree = NULL;
+}
+
+// Adds the value of the widget to value and returns true, or returns false and leaves
+// value as it was if the widget has no value to print.
+static bool getFormsWidgetValue(const QWidget *w, const QString &dateFormat, const QString &separator,
+                                const QString &listRowSeparator, ValueText &value)
+{
+    if (!w || w->property("guid_hide").toBool())
+        return false;
+    
+    QString var = w->property("guid_var").toString().simplified().replace(" ", "");
+    if (!var.isEmpty())
+        var += "=";
+    
+    IF_IS(QLineEdit) {
+        value.append(var + t->text());
+        return true;
+    } else IF_IS(QTreeView) {
+        if (t->selectionMode() == QAbstractItemView::NoSelection ||
+            t->property("guid_list_exclude_from_output").toBool())
+            return false;
+        
+        const ListModel *model = listModel(t);
+        if (!model)
+            return false;
+        
+        QString rowValue;
+        QString printColumn = t->property("guid_list_print_column").toString();
+        QString printMode = t->property("guid_list_print_values_mode").toString();
+        QString selectionType = t->property("guid_list_selection_type").toString();
+        QList<int> rowsToCheck;
+        
+        rowsToCheck = listOutputRows(t, selectionType == "checklist" || selectionType == "radiolist" ||
+                                     printMode == "all");
+        
+        // Each row is given to value on its own, so it can go straight to the output.
+        value.append(var);
+        if (selectionType == "checklist" || selectionType == "radiolist") {
+            bool isChecked = false;
+            int itemNo = 0;
+            foreach (int row, rowsToCheck) {
+                isChecked = model->isChecked(row);
+                
+                if (isChecked || printMode == "all") {
+                    rowValue = itemNo > 0 ? listRowSeparator : QString();
+                    for (int i = 0; i < model->columnCount(); ++i) {
+                        if (printColumn == "all" || printColumn == QString::number(i + 1)) {
                             if (i > 0)
                                 rowValue += ',';
                             
@@ -683,62 +2656,65 @@ static ValuePair getFormsWidgetValue(const QWidget *w, const QString &dateFormat
                                 else
                                     rowValue += "false";
                             } else {
-                                rowValue += item->text(i);
+                                rowValue += model->text(row, i);
                             }
                         }
                     }
-                    if (itemNo > 0)
-                        results += listRowSeparator;
-                    results += rowValue;
+                    value.append(rowValue);
                     itemNo++;
                 }
             }
         } else {
             int itemNo = 0;
-            foreach (QTreeWidgetItem *item, itemsToCheck) {
-                rowValue = "";
-                for (int i = 0; i < t->columnCount(); ++i) {
+            foreach (int row, rowsToCheck) {
+                rowValue = itemNo > 0 ? listRowSeparator : QString();
+                for (int i = 0; i < model->columnCount(); ++i) {
                     if (printColumn == "all" || printColumn == QString::number(i + 1)) {
                         if (i > 0)
                             rowValue += ',';
-                        rowValue += item->text(i);
+                        rowValue += model->text(row, i);
                     }
                 }
-                if (itemNo > 0)
-                    results += listRowSeparator;
-                results += rowValue;
+                value.append(rowValue);
                 itemNo++;
             }
         }
-        return ValuePair(true, var + results);
+        return true;
     } else IF_IS(QComboBox) {
-        return ValuePair(true, var + t->currentText());
+        value.append(var + t->currentText());
+        return true;
     } else IF_IS(QCalendarWidget) {
         if (dateFormat.isNull())
-            return ValuePair(true, var + QLocale::system().toString(t->selectedDate(), QLocale::ShortFormat));
-        return ValuePair(true, var + t->selectedDate().toString(dateFormat));
+            value.append(var + QLocale::system().toString(t->selectedDate(), QLocale::ShortFormat));
+        else
+            value.append(var + t->selectedDate().toString(dateFormat));
+        return true;
     } else IF_IS(QCheckBox) {
-        return ValuePair(true, t->isChecked() ? var + "true" : var + "false");
+        value.append(t->isChecked() ? var + "true" : var + "false");
+        return true;
     } else IF_IS(QSlider) {
-        return ValuePair(true, var + QString::number(t->value()));
+        value.append(var + QString::number(t->value()));
+        return true;
     } else IF_IS(QSpinBox) {
-        return ValuePair(true, var + QString::number(t->value()));
+        value.append(var + QString::number(t->value()));
+        return true;
     } else IF_IS(QDoubleSpinBox) {
-        return ValuePair(true, var + QString::number(t->value()));
+        value.append(var + QString::number(t->value()));
+        return true;
     } else IF_IS(QTabWidget) {
-        QString tabsValue = NULL;
-        ValuePair resultPair;
-        ValuePair tabPair;
+        const QString savedPending = value.pending();
+        value.setPending(savedPending + var);
+        // Size of the value once the name is written, more means a tab was added.
+        const qint64 tabsStart = value.size() + value.pending().size();
+        bool hasValue = false;
         
         bool verboseMode = t->property("guid_tab_bar_verbose").toBool();
-        QString tabValue = "";
         QString tabValuePrefix = "";
         QString tabValueSuffix = "";
         QString tabSelectionMarker = "";
         bool addTabValue = false;
         
         for (int i = 0; i < t->count(); ++i) {
-            tabValue = "";
             tabValuePrefix = "";
             tabValueSuffix = "";
             tabSelectionMarker = "";
@@ -755,75 +2731,78 @@ static ValuePair getFormsWidgetValue(const QWidget *w, const QString &dateFormat
                                  t->tabText(i) + "</TAB_END" + tabSelectionMarker + ">";
             }
             
+            const QString tabPending = value.pending();
+            value.setPending(tabPending + (value.size() > tabsStart ? separator : QString()) + tabValuePrefix);
+            const qint64 tabStart = value.size() + value.pending().size();
+            
+            if (tab->property("guid_tab_pending_args").isValid()) {
+                // Page never shown: the values of its fields were read by Guid::readTabPageValues().
+                QStringList pageValues = tab->property("guid_tab_default_values").toStringList();
+                addTabValue = !pageValues.isEmpty();
+                if (addTabValue)
+                    value.append(pageValues.join(separator));
+            }
+            
             QList<QWidget*> tabChildren = tab->findChildren<QWidget*>(QString(), Qt::FindDirectChildrenOnly);
             foreach(QWidget *tabChild, tabChildren) {
                 if (qstrcmp(tabChild->metaObject()->className(), "QLabel") == 0)
                     continue;
-                tabPair = getFormsWidgetValue(tabChild, dateFormat, separator, listRowSeparator);
-                if (tabPair.first) {
+                const QString childPending = value.pending();
+                value.setPending(childPending + (value.size() > tabStart ? separator : QString()));
+                if (getFormsWidgetValue(tabChild, dateFormat, separator, listRowSeparator, value))
                     addTabValue = true;
-                    if (!tabValue.isEmpty())
-                        tabValue += separator;
-                    tabValue += tabPair.second;
-                }
+                else
+                    value.setPending(childPending);
             }
             
             if (addTabValue) {
-                if (!tabsValue.isEmpty())
-                    tabsValue += separator;
-                tabsValue += tabValuePrefix + tabValue + tabValueSuffix;
+                value.append(tabValueSuffix);
+                hasValue = true;
+            } else {
+                value.setPending(tabPending);
             }
         }
         
-        resultPair = ValuePair(true, tabsValue);
-        if (tabsValue.isNull())
-            resultPair.first = false;
-        else
-            resultPair.second = var + resultPair.second;
-        
-        return resultPair;
+        if (!hasValue)
+            value.setPending(savedPending);
+        return hasValue;
     } else IF_IS(QTextEdit) {
         if (!t->isReadOnly()) {
-            ValuePair resultPair = ValuePair(true, var + t->toPlainText());
+            QString text = var + t->toPlainText();
             QString nsep = t->property("guid_text_info_nsep").toString();
             if (!nsep.isEmpty())
-                resultPair.second.replace("\n", nsep);
-            return resultPair;
+                text.replace("\n", nsep);
+            value.append(text);
+            return true;
         } else {
-            return ValuePair(false, QString());
+            return false;
         }
     } else IF_IS(QWidget) {
-        QString widgetsValue = NULL;
-        ValuePair resultPair;
-        ValuePair widgetPair;
+        int nbResults = 0;
+        const QString savedPending = value.pending();
+        value.setPending(savedPending + var);
         if (t->property("guid_list_container").toBool() ||
             t->property("guid_cols_container").toBool() ||
             t->property("guid_file_sel_container").toBool() ||
             t->property("guid_scale_container").toBool() ||
             qstrcmp(t->metaObject()->className(), "QGroupBox") == 0) {
-            int nbResults = 0;
             QList<QWidget*> wChildren = t->findChildren<QWidget*>(QString(), Qt::FindDirectChildrenOnly);
             foreach(QWidget *widget, wChildren) {
                 if (qstrcmp(widget->metaObject()->className(), "QLabel") == 0)
                     continue;
-                widgetPair = getFormsWidgetValue(widget, dateFormat, separator, listRowSeparator);
-                if (widgetPair.first) {
-                    if (nbResults > 0) {
-                        widgetsValue += separator;
-                    }
-                    widgetsValue += widgetPair.second;
+                const QString childPending = value.pending();
+                value.setPending(childPending + (nbResults > 0 ? separator : QString()));
+                if (getFormsWidgetValue(widget, dateFormat, separator, listRowSeparator, value))
                     nbResults++;
-                }
+                else
+                    value.setPending(childPending);
             }
         }
-        resultPair = ValuePair(true, widgetsValue);
-        if (widgetsValue.isNull())
-            resultPair.first = false;
-        else
-            resultPair.second = var + resultPair.second;
-        return resultPair;
+        if (nbResults == 0)
+            value.setPending(savedPending);
+        return nbResults > 0;
     }
-    return ValuePair(false, QString());
+    return false;
 }
 
 static bool getWidgetSettingBool(QString setting)
@@ -843,13 +2822,222 @@ static int getWidgetSettingInt(QString setting)
 
 static QString getWidgetSettingQString(QString setting)
 {
-    QStringList results = setting.split("=");
-    results.removeAt(0);
-    return results.join("=");
+    return setting.mid(setting.indexOf('=') + 1);
+}
+
+#define SETTER(_NAME_, _FIELD_, _GET_) \
+    setters.insert(_NAME_, [](WidgetSettings &ws, const QString &setting) { ws._FIELD_ = _GET_(setting); });
+#define MARKER_SETTERS(_N_) \
+    SETTER("defMarkerVal" #_N_, defMarkerVal[_N_ - 1], getWidgetSettingQString) \
+    SETTER("monitorMarkerFile" #_N_, monitorMarkerFile[_N_ - 1], getWidgetSettingQString) \
+    SETTER("monitorVarName" #_N_, monitorVarName[_N_ - 1], getWidgetSettingQString)
+
+static const QHash<QString, WidgetSettingSetter> &widgetSettingSetters()
+{
+    static QHash<QString, WidgetSettingSetter> setters;
+    if (!setters.isEmpty())
+        return setters;
+    
+    SETTER("addLabel", addLabel, getWidgetSettingQString)
+    SETTER("addNewRowButton", addNewRowButton, getWidgetSettingBool)
+    SETTER("async", async, getWidgetSettingBool)
+    SETTER("backgroundColor", backgroundColor, getWidgetSettingQString)
+    SETTER("buttonText", buttonText, getWidgetSettingQString)
+    SETTER("command", command, getWidgetSettingQString)
+    SETTER("commandToFooter", commandToFooter, getWidgetSettingBool)
+    SETTER("defaultIndex", defaultIndex, getWidgetSettingInt)
+    SETTER("disableButtons", disableButtons, getWidgetSettingBool)
+    SETTER("excludeFromOutput", excludeFromOutput, getWidgetSettingBool)
+    SETTER("foregroundColor", foregroundColor, getWidgetSettingQString)
+    SETTER("format", format, getWidgetSettingQString)
+    SETTER("hideLabel", hideLabel, getWidgetSettingBool)
+    SETTER("image", image, getWidgetSettingQString)
+    SETTER("keepOpen", keepOpen, getWidgetSettingBool)
+    SETTER("monitor", monitorFile, getWidgetSettingBool)
+    SETTER("queue", queue, getWidgetSettingInt)
+    SETTER("sep", sep, getWidgetSettingQString)
+    SETTER("stop", stop, getWidgetSettingBool)
+    SETTER("valuesToFooter", valuesToFooter, getWidgetSettingBool)
+    SETTER("verboseTabBar", verboseTabBar, getWidgetSettingBool)
+    MARKER_SETTERS(1) MARKER_SETTERS(2) MARKER_SETTERS(3)
+    MARKER_SETTERS(4) MARKER_SETTERS(5) MARKER_SETTERS(6)
+    MARKER_SETTERS(7) MARKER_SETTERS(8) MARKER_SETTERS(9)
+    return setters;
+}
+
+#undef MARKER_SETTERS
+#undef SETTER
+
+// Widget settings are "name=value" chunks separated with '@'. Each chunk costs one lookup,
+// unknown ones belong to the value of the argument, which is returned.
+static QString readWidgetSettings(const QString &arg, WidgetSettings &ws)
+{
+    const QHash<QString, WidgetSettingSetter> &setters = widgetSettingSetters();
+    QStringList remains;
+    foreach (const QString &setting, arg.split('@')) {
+        const int split = setting.indexOf('=');
+        WidgetSettingSetter setter = split > 0 ? setters.value(setting.left(split)) : NULL;
+        if (setter)
+            setter(ws, setting);
+        else
+            remains << setting;
+    }
+    return remains.join('@');
+}
+
+// Single pass over the trimmed content: a run of line breaks ends an entry, and so does sep.
+static QStringList splitFileLines(const QByteArray &data, const QString &sep)
+{
+    const QString content = QString::fromUtf8(data).trimmed();
+    const QChar *chars = content.constData();
+    const int length = content.length();
+    const int sepLength = sep.length();
+    const QChar sepStart = sepLength ? sep.at(0) : QChar();
+    
+    QStringList lines;
+    int start = 0;
+    for (int i = 0; i < length;) {
+        if (chars[i] == '\r' || chars[i] == '\n') {
+            lines << content.mid(start, i - start);
+            while (i < length && (chars[i] == '\r' || chars[i] == '\n'))
+                ++i;
+            start = i;
+        } else if (sepLength && chars[i] == sepStart && content.midRef(i, sepLength) == sep) {
+            lines << content.mid(start, i - start);
+            i += sepLength;
+            start = i;
+        } else {
+            ++i;
+        }
+    }
+    lines << content.mid(start);
+    return lines;
+}
+
+// Both run on any thread. A file that can't be read gives a null result, an empty one doesn't.
+static QByteArray readFileContent(const QString &filePath)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly))
+        return QByteArray();
+    QByteArray content = file.readAll();
+    return content.isNull() ? QByteArray("") : content;
+}
+
+static QStringList readFileLines(const QString &filePath, const QString &sep)
+{
+    QByteArray content = readFileContent(filePath);
+    return content.isNull() ? QStringList() : splitFileLines(content, sep);
+}
+
+// The canonical list of options has "--key=value" given as "--key" then "value".
+static QStringList splitOptions(const QStringList &argList, int first = 0)
+{
+    QStringList args;
+    for (int i = first; i < argList.count(); ++i) {
+        if (argList.at(i).startsWith("--")) {
+            int split = argList.at(i).indexOf('=');
+            if (split > -1) {
+                args << argList.at(i).left(split) << argList.at(i).mid(split+1);
+            } else {
+                args << argList.at(i);
+            }
+        } else {
+            args << argList.at(i);
+        }
+    }
+    return args;
+}
+
+// A --forms-spec file holds one option per line, written as on the command line but
+// without shell quoting. Blank lines and lines starting with # are skipped. The split
+// options are cached in the user's cache directory under the hash of the content, so
+// launching the same form again only reads them back. The directory and the files are the
+// user's own, and a cache file only counts if it has the format version and the hash of
+// the spec it's for.
+static bool readFormsSpec(const QString &filePath, QStringList &options)
+{
+    enum { CacheMagic = 0x47554944, CacheVersion = 2 };
+    const QByteArray content = readFileContent(filePath);
+    if (content.isNull())
+        return false;
+    const QByteArray hash = QCryptographicHash::hash(content, QCryptographicHash::Sha1);
+    const QString cacheDir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/forms-spec";
+    const QString cachePath = cacheDir + '/' + QString::fromLatin1(hash.toHex()) + ".guidcache";
+    const QFileDevice::Permissions ownerOnly = QFileDevice::ReadOwner | QFileDevice::WriteOwner;
+    
+    auto isPrivate = [](const QFileInfo &info) {
+        const QFileDevice::Permissions others = QFileDevice::ReadGroup | QFileDevice::WriteGroup |
+                                               QFileDevice::ReadOther | QFileDevice::WriteOther;
+        #ifdef Q_OS_UNIX
+            if (info.ownerId() != ::geteuid())
+                return false;
+        #endif
+        return info.exists() && !(info.permissions() & others);
+    };
+    
+    QFile cache(cachePath);
+    if (isPrivate(QFileInfo(cacheDir)) && isPrivate(QFileInfo(cachePath)) && cache.open(QIODevice::ReadOnly)) {
+        QDataStream in(&cache);
+        in.setVersion(QDataStream::Qt_5_0);
+        quint32 magic = 0, version = 0;
+        QByteArray cachedHash;
+        in >> magic >> version >> cachedHash;
+        if (magic == CacheMagic && version == CacheVersion && cachedHash == hash) {
+            in >> options;
+            if (in.status() == QDataStream::Ok && in.atEnd())
+                return true;
+        }
+        options.clear();
+    }
+    
+    QStringList lines;
+    foreach (const QByteArray &line, content.split('\n')) {
+        const QString option = QString::fromUtf8(line).trimmed();
+        if (!option.isEmpty() && !option.startsWith('#'))
+            lines << option;
+    }
+    options = splitOptions(lines);
+    
+    // Without a writable cache directory, the file is simply parsed every time.
+    if (!QDir().mkpath(cacheDir) ||
+        !QFile::setPermissions(cacheDir, ownerOnly | QFileDevice::ExeOwner))
+        return true;
+    QSaveFile newCache(cachePath);
+    if (newCache.open(QIODevice::WriteOnly) && newCache.setPermissions(ownerOnly)) {
+        QDataStream out(&newCache);
+        out.setVersion(QDataStream::Qt_5_0);
+        out << quint32(CacheMagic) << quint32(CacheVersion) << hash << options;
+        newCache.commit();
+    }
+    return true;
+}
+
+// Runs load() on the global thread pool and done() on the GUI thread, unless the widget is
+// gone by then or a newer load was started for it. The widget shows a busy cursor meanwhile.
+template <class T> static void loadInBackground(QWidget *widget, const std::function<T()> &load,
+                                                const std::function<void(const T&)> &done)
+{
+    const int loadId = widget->property("guid_load_id").toInt() + 1;
+    widget->setProperty("guid_load_id", loadId);
+    widget->setCursor(Qt::BusyCursor);
+    const qint64 traceStart = TraceSpan::now();
+    
+    QFutureWatcher<T> *watcher = new QFutureWatcher<T>(widget);
+    QObject::connect(watcher, &QFutureWatcher<T>::finished, widget, [=]() {
+        if (widget->property("guid_load_id").toInt() == loadId) {
+            widget->unsetCursor();
+            done(watcher->result());
+            TraceSpan::write("background load", traceStart, TraceSpan::member("widget", widget->metaObject()->className()));
+        }
+        watcher->deleteLater();
+    });
+    watcher->setFuture(QtConcurrent::run(load));
 }
 
 static GList listValuesFromFile(QString data)
 {
+    TraceSpan span("listValuesFromFile");
     GList list = GList();
     QStringList data_join;
     QStringList data_split = data.split('@');
@@ -866,32 +3054,55 @@ static GList listValuesFromFile(QString data)
     if (list.fileSep.isEmpty())
         list.fileSep = "\n";
     list.filePath = data_join.join('@');
-    QFile file(list.filePath);
     QTextCodec::setCodecForLocale(QTextCodec::codecForName("UTF-8"));
-    if (file.open(QIODevice::ReadOnly)) {
-        list.val = QString::fromLocal8Bit(file.readAll()).trimmed().replace(QRegExp("[\r\n]+"), list.fileSep).split(list.fileSep);
-        file.close();
-    }
+    list.val = readFileLines(list.filePath, list.fileSep);
+    span.arg("path", list.filePath);
+    span.arg("values", list.val.count());
     return list;
 }
 
-static bool pathTester(QString filePath)
+// Returns false when the file has the stamp seen by the previous call for this object,
+// i.e. the watcher fired but there is nothing to reload. On Unix the stamp also holds the
+// inode and the status change time, so a file replaced by a rename is reloaded. A file
+// modified less than a second before the previous check is always reloaded: a coarse
+// timestamp can't tell that write from a later one with the same size.
+static bool fileStampChanged(QObject *o, const QString &filePath)
 {
-    bool fileExists = false;
-    int timer = 500;
-    
-    while (timer > 0) {
-        if (QFile::exists(filePath)) {
-            fileExists = true;
-            
-            break;
-        }
-        
-        timer = timer - 20;
-        QThread::msleep(20);
-    }
-    
-    return fileExists;
+    const QFileInfo info(filePath);
+    const qint64 mtime = info.lastModified().toMSecsSinceEpoch();
+    QString stamp = QString("%1:%2").arg(info.size()).arg(mtime);
+    #ifdef Q_OS_UNIX
+        struct stat st;
+        if (::stat(QFile::encodeName(filePath).constData(), &st) == 0)
+            stamp += QString(":%1:%2:%3").arg(qulonglong(st.st_dev)).arg(qulonglong(st.st_ino))
+                                         .arg(qlonglong(st.st_ctime));
+    #endif
+    const qint64 checked = QDateTime::currentMSecsSinceEpoch();
+    const bool recent = o->property("guid_file_mtime").toLongLong() >=
+                        o->property("guid_file_checked").toLongLong() - 1000;
+    if (o->property("guid_file_stamp").toString() == stamp && !recent)
+        return false;
+    o->setProperty("guid_file_stamp", stamp);
+    o->setProperty("guid_file_mtime", mtime);
+    o->setProperty("guid_file_checked", checked);
+    return true;
+}
+
+// Same as the list model's updateValues(): only the items between the unchanged head and
+// tail are replaced, so the current item survives a reload of the file.
+static void updateComboItems(QComboBox *combo, const QStringList &values)
+{
+    const int count = combo->count();
+    int head = 0;
+    while (head < count && head < values.count() && combo->itemText(head) == values.at(head))
+        ++head;
+    int tail = 0;
+    while (tail < count - head && tail < values.count() - head &&
+           combo->itemText(count - 1 - tail) == values.at(values.count() - 1 - tail))
+        ++tail;
+    for (int i = count - tail - 1; i >= head; --i)
+        combo->removeItem(i);
+    combo->insertItems(head, values.mid(head, values.count() - head - tail));
 }
 
 static void setGroup(QGroupBox* &group, QFormLayout* &layout, QLabel* groupLabel, QString &lastGroupName)
@@ -905,6 +3116,74 @@ static void setGroup(QGroupBox* &group, QFormLayout* &layout, QLabel* groupLabel
     lastGroupName = "";
 }
 
+// Forms options applying to the whole dialog rather than to a field, each mapped to whether it
+// takes a value.
+static const QHash<QString, bool> &formsDialogOptions()
+{
+    static const QHash<QString, bool> options = {
+        {"--action-after-ok-click", true},
+        {"--close-to-systray", false},
+        {"--footer-entries", true},
+        {"--footer-from-file", true},
+        {"--footer-name", true},
+        {"--forms-align", true},
+        {"--forms-date-format", true},
+        {"--header", true},
+        {"--lazy-tabs", false},
+        {"--list-row-separator", true},
+        {"--no-cancel", false},
+        {"--ok-coprocess", true},
+        {"--separator", true},
+        {"--systray-icon", true},
+        {"--tab-visible", false},
+        {"--text", true},
+        {"--win-max-button", false},
+        {"--win-min-button", false}
+    };
+    return options;
+}
+
+// Moves the fields of every tab but the first one of each tab bar out of the forms arguments,
+// keyed by the position of their "--tab" argument. Dialog settings are left in place.
+static QStringList deferTabPages(const QStringList &args, QHash<int, QStringList> &pages)
+{
+    const QHash<QString, bool> &dialogOptions = formsDialogOptions();
+    
+    QStringList formArgs;
+    QString tabName = "";
+    int tabIndex = -1;
+    int page = -1;
+    for (int i = 0; i < args.count(); ++i) {
+        if (args.at(i) == "--tab") {
+            const int tabArg = formArgs.count();
+            formArgs << args.at(i);
+            if (i + 1 < args.count())
+                formArgs << args.at(++i);
+            WidgetSettings ws;
+            QString name = readWidgetSettings(formArgs.last(), ws);
+            if (ws.stop) {
+                tabName = "";
+                tabIndex = -1;
+                page = -1;
+            } else if (tabName.isEmpty() || tabName != name) {
+                // The first tab is shown with the dialog, so it's built right away.
+                page = tabName.isEmpty() ? -1 : tabArg;
+                tabIndex++;
+                tabName = name.isEmpty() ? QString("Tab %1").arg(tabIndex) : name;
+            }
+        } else if (page < 0) {
+            formArgs << args.at(i);
+        } else if (dialogOptions.contains(args.at(i))) {
+            formArgs << args.at(i);
+            if (dialogOptions.value(args.at(i)) && i + 1 < args.count())
+                formArgs << args.at(++i);
+        } else {
+            pages[page] << args.at(i);
+        }
+    }
+    return formArgs;
+}
+
 static void setTabBar(QTabWidget* &tabBar, QFormLayout* &layout, QLabel* tabBarLabel, QString &tabName, int &tabIndex)
 {
     if (tabBarLabel)
@@ -919,84 +3198,270 @@ static void setTabBar(QTabWidget* &tabBar, QFormLayout* &layout, QLabel* tabBarL
     tabIndex = -1;
 }
 
+static QString qrCodeKey(const QString &text, qrcodegen::QrCode::Ecc ecc, int side)
+{
+    return QString("%1@%2@").arg(side).arg(static_cast<int>(ecc)) + text;
+}
+
+// Safe to call from any thread. The 1-bit image is written one scanline at a time at its
+// final size (nearest module), rows mapping to the same module row are copied.
+static QImage qrCodeImage(const QString &text, qrcodegen::QrCode::Ecc ecc, int side)
+{
+    qrcodegen::QrCode qrCode = qrcodegen::QrCode::encodeText(text.toUtf8().constData(), ecc);
+    const int qrCodeSize = qrCode.getSize();
+    QImage image(side, side, QImage::Format_Mono);
+    image.setColor(0, qRgb(255, 255, 255));
+    image.setColor(1, qRgb(0, 0, 0));
+    const int bytesPerLine = image.bytesPerLine();
+    int lastY = -1;
+    for (int row = 0; row < side; ++row) {
+        uchar *line = image.scanLine(row);
+        const int y = row * qrCodeSize / side;
+        if (y == lastY) {
+            memcpy(line, image.constScanLine(row - 1), bytesPerLine);
+            continue;
+        }
+        lastY = y;
+        memset(line, 0, bytesPerLine);
+        for (int col = 0; col < side; ++col) {
+            if (qrCode.getModule(col * qrCodeSize / side, y))
+                line[col >> 3] |= 0x80 >> (col & 7);
+        }
+    }
+    return image;
+}
+
+static const MarkerFile &markerFile(const QString &filePath)
+{
+    QHash<QString, MarkerFile>::const_iterator it = gs_markerFiles.constFind(filePath);
+    if (it != gs_markerFiles.constEnd())
+        return *it;
+    
+    MarkerFile marker;
+    QFile file(filePath);
+    if (file.open(QIODevice::ReadOnly)) {
+        QByteArray markerValue = file.readAll();
+        while (markerValue.right(1) == "\n")
+            markerValue.chop(1);
+        marker.content = QString(markerValue);
+        marker.readable = true;
+        file.close();
+        
+        QString lines = marker.content;
+        lines.replace(QRegExp("[\r\n]+"), "\n");
+        foreach (QString line, lines.split("\n")) {
+            QString varName = line.section('=', 0, 0);
+            if (!marker.vars.contains(varName))
+                marker.vars.insert(varName, line.section('=', 1, 1));
+        }
+    }
+    return *gs_markerFiles.insert(filePath, marker);
+}
+
+// Splits a text template into literal text and GUID_MARKER_n numbers, alternately, so
+// that filling it is a single concatenation: "literal", "n", "literal", ..., "literal".
+static QStringList markerSegments(const QString &textTemplate)
+{
+    static const QString marker("GUID_MARKER_");
+    QStringList segments;
+    int literalStart = 0;
+    int pos = 0;
+    while ((pos = textTemplate.indexOf(marker, pos)) > -1) {
+        pos += marker.length();
+        if (pos < textTemplate.length() && textTemplate.at(pos) >= '1' && textTemplate.at(pos) <= '9') {
+            segments << textTemplate.mid(literalStart, pos - marker.length() - literalStart) << textTemplate.at(pos);
+            literalStart = ++pos;
+        }
+    }
+    segments << textTemplate.mid(literalStart);
+    return segments;
+}
+
+static QString fillMarkerSegments(const QStringList &segments, const QStringList &values)
+{
+    int length = 0;
+    for (int i = 0; i < segments.count(); ++i)
+        length += i % 2 ? values.at(segments.at(i).at(0).digitValue() - 1).length() : segments.at(i).length();
+    QString result;
+    result.reserve(length);
+    for (int i = 0; i < segments.count(); ++i)
+        result += i % 2 ? values.at(segments.at(i).at(0).digitValue() - 1) : segments.at(i);
+    return result;
+}
+
 static void setText(QLabel *text)
 {
-    QString textTemplate = text->property("guid_text_content").toString();
-    QString textContent = textTemplate;
-    QString defaultTextContent = textTemplate;
+    QStringList segments = text->property("guid_text_segments").toStringList();
+    if (segments.isEmpty()) {
+        segments = markerSegments(text->property("guid_text_content").toString());
+        text->setProperty("guid_text_segments", segments);
+    }
+    
+    QStringList defaultValues;
+    for (int i = 0; i < 9; ++i) {
+        QString defMarkerVal = text->property(gs_defMarkerValProps[i]).toString();
+        defaultValues << (defMarkerVal.isEmpty() ? "(?)" : defMarkerVal);
+    }
     
     if (!text->property("guid_text_markers_set").toBool()) {
-        for (int i = 1; i < 10; ++i) {
-            QString propDefMarkerVal = "guid_text_def_marker_val_" + QString::number(i);
-            QString defMarkerVal = text->property(propDefMarkerVal.toStdString().c_str()).toString();
-            if (defMarkerVal.isEmpty())
-                defMarkerVal = "(?)";
-            defaultTextContent.replace("GUID_MARKER_" + QString::number(i), defMarkerVal);
-        }
-        
-        text->setText(defaultTextContent);
+        text->setText(fillMarkerSegments(segments, defaultValues));
         text->setProperty("guid_text_markers_set", true);
     }
     
-    for (int i = 1; i < 10; ++i) {
-        QString propDefMarkerVal = "guid_text_def_marker_val_" + QString::number(i);
-        QString defMarkerVal = text->property(propDefMarkerVal.toStdString().c_str()).toString();
-        if (defMarkerVal.isEmpty())
-                defMarkerVal = "(?)";
-        
-        QString propMarkerFile = "guid_text_monitor_marker_file_" + QString::number(i);
-        QString filePath = text->property(propMarkerFile.toStdString().c_str()).toString();
+    QStringList values;
+    for (int i = 0; i < 9; ++i) {
+        // Markers without a readable file are left as they are.
+        QString newValue = "GUID_MARKER_" + QString::number(i + 1);
+        QString filePath = text->property(gs_markerFileProps[i]).toString();
         
         if (!filePath.isEmpty()) {
-            QFile file(filePath);
-            QTextCodec::setCodecForLocale(QTextCodec::codecForName("UTF-8"));
+            const MarkerFile &marker = markerFile(filePath);
             
-            if (file.open(QIODevice::ReadOnly)) {
-                QByteArray markerValue = file.readAll();
-                while (markerValue.right(1) == "\n")
-                    markerValue.chop(1);
-                
-                QString newValue = QString(markerValue);
-                QString propMonitorVarName = "guid_text_monitor_var_name_" + QString::number(i);
-                QString monitorVarName = text->property(propMonitorVarName.toStdString().c_str()).toString();
-                bool varFound = false;
-                if (!monitorVarName.isEmpty()) {
-                    newValue.replace(QRegExp("[\r\n]+"), "\n");
-                    QStringList newValueLines = newValue.split("\n");
-                    foreach(QString line, newValueLines) {
-                        QString varName = line.section('=', 0, 0);
-                        if (varName == monitorVarName) {
-                            varFound = true;
-                            newValue = line.section('=', 1, 1);
-                            break;
-                        }
-                    }
-                    if (!varFound)
-                        newValue = "";
-                }
-                
+            if (marker.readable) {
+                QString monitorVarName = text->property(gs_markerVarNameProps[i]).toString();
+                newValue = monitorVarName.isEmpty() ? marker.content : marker.vars.value(monitorVarName);
                 if (newValue.isEmpty())
-                    newValue = defMarkerVal;
-                
-                textContent.replace("GUID_MARKER_" + QString::number(i), newValue);
-                
-                file.close();
+                    newValue = defaultValues.at(i);
             }
         }
+        values << newValue;
     }
     
+    if (text->property("guid_text_marker_values").toStringList() == values)
+        return; // nothing changed since the last update
+    text->setProperty("guid_text_marker_values", values);
+    
+    QString textContent = fillMarkerSegments(segments, values);
     if (text->text() != textContent)
         text->setText(textContent);
 }
 
-static void setTextInfo(QTextEdit *textInfo)
+// The URL is fetched in-process through a manager shared by all widgets (so connections are
+// kept alive), or with curl when its path is given. The validators of the last response make
+// refreshing an unchanged page a bodyless 304, which leaves the document alone.
+static void fetchUrl(QTextEdit *textEdit, const QString &url, const QString &curlPath,
+                     const std::function<void(const QByteArray&)> &setContent)
+{
+    const qint64 traceStart = TraceSpan::now();
+    textEdit->setProperty("guid_text_fetching", true);
+    if (!curlPath.isEmpty()) {
+        QProcess *curl = new QProcess(textEdit);
+        QObject::connect(curl, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), textEdit, [=]() {
+            textEdit->setProperty("guid_text_fetching", false);
+            setContent(curl->readAllStandardOutput());
+            TraceSpan::write("fetchUrl", traceStart, TraceSpan::member("url", url) + ',' +
+                             TraceSpan::member("curl", curlPath));
+            curl->deleteLater();
+        });
+        QObject::connect(curl, &QProcess::errorOccurred, textEdit, [=](QProcess::ProcessError error) {
+            if (error != QProcess::FailedToStart)
+                return; // finished() follows
+            textEdit->setProperty("guid_text_fetching", false);
+            qWarning().noquote() << "cannot run" << curlPath;
+            curl->deleteLater();
+        });
+        curl->start(curlPath, QStringList() << "-L" << "-s" << url);
+        return;
+    }
+    
+    static QNetworkAccessManager *manager = new QNetworkAccessManager(qApp);
+    QNetworkRequest request = QNetworkRequest(QUrl(url));
+    request.setAttribute(QNetworkRequest::FollowRedirectsAttribute, true);
+    QByteArray etag = textEdit->property("guid_text_etag").toByteArray();
+    if (!etag.isEmpty())
+        request.setRawHeader("If-None-Match", etag);
+    QByteArray lastModified = textEdit->property("guid_text_last_modified").toByteArray();
+    if (!lastModified.isEmpty())
+        request.setRawHeader("If-Modified-Since", lastModified);
+    
+    QNetworkReply *reply = manager->get(request);
+    reply->setParent(textEdit); // aborted if the widget goes first
+    QObject::connect(reply, &QNetworkReply::finished, textEdit, [=]() {
+        textEdit->setProperty("guid_text_fetching", false);
+        int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+        if (reply->error() == QNetworkReply::NoError && status != 304) {
+            textEdit->setProperty("guid_text_etag", reply->rawHeader("ETag"));
+            textEdit->setProperty("guid_text_last_modified", reply->rawHeader("Last-Modified"));
+            setContent(reply->readAll());
+        }
+        TraceSpan::write("fetchUrl", traceStart, TraceSpan::member("url", url) + ',' +
+                         TraceSpan::member("status", status));
+        reply->deleteLater();
+    });
+}
+
+static const char urlRefreshError[] = "--url-refresh must be followed by a positive number of seconds";
+
+// Seconds of a --url-refresh argument, 0 when it isn't a positive number.
+static int urlRefreshSeconds(const QString &arg)
+{
+    bool ok;
+    const int seconds = arg.toInt(&ok);
+    return ok && seconds > 0 && seconds <= INT_MAX / 1000 ? seconds : 0;
+}
+
+// A tick that comes while the previous fetch is still running is skipped.
+static void refreshUrl(QTextEdit *textEdit, int seconds, const std::function<void()> &fetch)
+{
+    if (seconds <= 0)
+        return;
+    QTimer *refreshTimer = new QTimer(textEdit);
+    refreshTimer->setInterval(seconds * 1000);
+    QObject::connect(refreshTimer, &QTimer::timeout, textEdit, [=]() {
+        if (!textEdit->property("guid_text_fetching").toBool())
+            fetch();
+    });
+    refreshTimer->start();
+}
+
+static void setTextInfoContent(QTextEdit *textInfo, QByteArray content)
+{
+    QString format = textInfo->property("guid_text_format").toString();
+    while (content.right(1) == "\n")
+        content.chop(1);
+    if (format == "html")
+        textInfo->setHtml(QString::fromLocal8Bit(content));
+    else if (format == "plain")
+        textInfo->setPlainText(QString::fromLocal8Bit(content));
+    else
+        textInfo->setText(QString::fromLocal8Bit(content));
+}
+
+static void fitTextInfoHeight(QTextEdit *textInfo)
+{
+    bool isUrl = textInfo->property("guid_text_is_url").toBool();
+    QString format = textInfo->property("guid_text_format").toString();
+    int heightToSet = textInfo->property("guid_text_height").toInt();
+    
+    QFont defaultFont = textInfo->document()->defaultFont();
+    QFontMetrics fontMetrics = QFontMetrics(defaultFont);
+    QSize size = fontMetrics.size(0, textInfo->toPlainText());
+    qreal documentMargin = textInfo->document()->documentMargin();
+    QMargins contentsMargins = textInfo->contentsMargins();
+    int currentHeight = size.height() + contentsMargins.top() + contentsMargins.bottom() + documentMargin * 2;
+    
+    if (!isUrl && format != "html")
+        textInfo->setMaximumHeight(currentHeight);
+    
+    if (heightToSet >= 0 && (heightToSet < currentHeight || format == "html" || isUrl))
+        textInfo->setMaximumHeight(heightToSet);
+}
+
+// Whether the text widget prints its content, which then has to be loaded even for a page
+// whose values only are read.
+static bool hasTextInfoValue(const QTextEdit *textInfo)
+{
+    return !textInfo->property("guid_text_read_only").toBool() && !textInfo->property("guid_text_is_url").toBool();
+}
+
+// Files monitored for changes are read again off the GUI thread (async).
+static void setTextInfo(QTextEdit *textInfo, bool async = false)
 {
     QString filename = textInfo->property("guid_text_filename").toString();
     bool isReadOnly = textInfo->property("guid_text_read_only").toBool();
     bool isUrl = textInfo->property("guid_text_is_url").toBool();
-    QString format = textInfo->property("guid_text_format").toString();
     QString curlPath = textInfo->property("guid_text_curl_path").toString();
-    int heightToSet = textInfo->property("guid_text_height").toInt();
+    int urlRefresh = textInfo->property("guid_text_url_refresh").toInt();
     
     textInfo->setReadOnly(isReadOnly);
     if (textInfo->isReadOnly()) {
@@ -1011,53 +3476,208 @@ static void setTextInfo(QTextEdit *textInfo)
         textInfo->setFrameStyle(QFrame::NoFrame);
     }
     
+    QTextCodec::setCodecForLocale(QTextCodec::codecForName("UTF-8"));
     if (isUrl) {
-        if (curlPath.isEmpty())
-            curlPath = "curl";
-        QProcess *curl = new QProcess;
-        QObject::connect(curl, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), [=]() {
-            QByteArray content = curl->readAllStandardOutput();
-            while (content.right(1) == "\n")
-                content.chop(1);
-            if (format == "html")
-                textInfo->setHtml(QString::fromLocal8Bit(content));
-            else if (format == "plain")
-                textInfo->setPlainText(QString::fromLocal8Bit(content));
-            else
-                textInfo->setText(QString::fromLocal8Bit(content));
-            delete curl;
+        std::function<void()> fetch = [=]() {
+            fetchUrl(textInfo, filename, curlPath, [=](const QByteArray &content) {
+                setTextInfoContent(textInfo, content);
+            });
+        };
+        fetch();
+        refreshUrl(textInfo, urlRefresh, fetch);
+    } else if (async) {
+        loadInBackground<QByteArray>(textInfo, [=]() { return readFileContent(filename); },
+                                     [=](const QByteArray &content) {
+            if (!content.isNull()) {
+                setTextInfoContent(textInfo, content);
+                fitTextInfoHeight(textInfo);
+            }
         });
-        curl->start(curlPath, QStringList() << "-L" << "-s" << filename);
+        return;
     } else {
-        QFile file(filename);
-        QTextCodec::setCodecForLocale(QTextCodec::codecForName("UTF-8"));
-        if (file.open(QIODevice::ReadOnly)) {
-            QByteArray content = file.readAll();
-            while (content.right(1) == "\n")
-                content.chop(1);
-            if (format == "html")
-                textInfo->setHtml(QString::fromLocal8Bit(content));
-            else if (format == "plain")
-                textInfo->setPlainText(QString::fromLocal8Bit(content));
-            else
-                textInfo->setText(QString::fromLocal8Bit(content));
-            file.close();
-        }
+        QByteArray content = readFileContent(filename);
+        if (!content.isNull())
+            setTextInfoContent(textInfo, content);
     }
     
-    QFont defaultFont = textInfo->document()->defaultFont();
-    QFontMetrics fontMetrics = QFontMetrics(defaultFont);
-    QSize size = fontMetrics.size(0, textInfo->toPlainText());
-    qreal documentMargin = textInfo->document()->documentMargin();
-    QMargins contentsMargins = textInfo->contentsMargins();
-    int currentHeight = size.height() + contentsMargins.top() + contentsMargins.bottom() + documentMargin * 2;
-    
-    if (!isUrl && format != "html")
-        textInfo->setMaximumHeight(currentHeight);
+    fitTextInfoHeight(textInfo);
+}
+
+#ifdef Q_OS_UNIX
+// Server mode protocol: the client sends a quint32 length followed by NUL terminated
+// strings (working directory, parent pid, the number of environment variables, the
+// variables, then argv) and passes its stdin, stdout and stderr along with SCM_RIGHTS.
+// The server answers with the qint32 exit code.
+
+static QList<QByteArray> environmentList()
+{
+    QList<QByteArray> vars;
+    for (char **var = environ; *var; ++var)
+        vars << QByteArray(*var);
+    return vars;
+}
+
+// Replaces the whole environment, the ok-commands and the other children then get the
+// one of the client.
+static void setEnvironment(const QList<QByteArray> &vars)
+{
+    QSet<QByteArray> names;
+    foreach (const QByteArray &var, vars)
+        names << var.left(var.indexOf('='));
+    foreach (const QByteArray &var, environmentList()) {
+        const QByteArray name = var.left(var.indexOf('='));
+        if (!names.contains(name))
+            ::unsetenv(name.constData());
+    }
+    foreach (const QByteArray &var, vars) {
+        const int split = var.indexOf('=');
+        if (split > 0)
+            ::setenv(var.left(split).constData(), var.constData() + split + 1, 1);
+    }
+}
+
+// Only the user running the server can ask it for dialogs.
+static bool isSameUser(int fd)
+{
+    #ifdef SO_PEERCRED
+        ucred credentials;
+        socklen_t size = sizeof(credentials);
+        return ::getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &credentials, &size) == 0 &&
+               credentials.uid == ::geteuid();
+    #else
+        uid_t uid;
+        gid_t gid;
+        return ::getpeereid(fd, &uid, &gid) == 0 && uid == ::geteuid();
+    #endif
+}
+
+// Waits for fd to be readable until the deadline, if any, is past.
+static bool socketWait(int fd, const QDeadlineTimer &deadline)
+{
+    pollfd request = { fd, POLLIN, 0 };
+    int n;
+    do {
+        n = ::poll(&request, 1, deadline.isForever() ? -1 : int(deadline.remainingTime()));
+    } while (n < 0 && errno == EINTR);
+    return n > 0;
+}
+
+static bool socketRead(int fd, char *data, size_t size,
+                       const QDeadlineTimer &deadline = QDeadlineTimer(QDeadlineTimer::Forever))
+{
+    while (size > 0) {
+        if (!socketWait(fd, deadline))
+            return false;
+        const ssize_t n = ::read(fd, data, size);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        data += n;
+        size -= n;
+    }
+    return true;
+}
+
+static bool socketWrite(int fd, const char *data, size_t size)
+{
+    while (size > 0) {
+        const ssize_t n = ::send(fd, data, size, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        data += n;
+        size -= n;
+    }
+    return true;
+}
+
+static bool socketAddress(const QByteArray &socketPath, sockaddr_un &address)
+{
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (socketPath.isEmpty() || socketPath.size() >= (int)sizeof(address.sun_path))
+        return false;
+    memcpy(address.sun_path, socketPath.constData(), socketPath.size());
+    return true;
+}
+
+// Returns the exit code of the dialog shown by the server, or -1 if there's no server or
+// it doesn't take the request within AcceptTimeoutMs, e.g. because it's showing the dialog
+// of another client: the dialog is then shown in-process.
+static int runAsClient(const QByteArray &socketPath, int argc, char **argv)
+{
+    enum { AcceptTimeoutMs = 500 };
+    sockaddr_un address;
+    if (!socketAddress(socketPath, address))
+        return -1;
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+        return -1;
+    if (::connect(fd, (sockaddr*)&address, sizeof(address)) < 0) {
+        ::close(fd);
+        return -1;
+    }
     
-    if (heightToSet >= 0 && (heightToSet < currentHeight || format == "html" || isUrl))
-        textInfo->setMaximumHeight(heightToSet);
+    char cwd[PATH_MAX];
+    QByteArray payload(::getcwd(cwd, sizeof(cwd)) ? cwd : ".");
+    payload += '\0' + QByteArray::number(getppid()) + '\0';
+    const QList<QByteArray> vars = environmentList();
+    payload += QByteArray::number(vars.count()) + '\0';
+    foreach (const QByteArray &var, vars)
+        payload += var + '\0';
+    for (int i = 0; i < argc; ++i)
+        payload += QByteArray(argv[i]) + '\0';
+    
+    quint32 length = payload.size();
+    int fds[3] = { STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO };
+    char control[CMSG_SPACE(sizeof(fds))];
+    memset(control, 0, sizeof(control));
+    iovec iov = { &length, sizeof(length) };
+    msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(fds));
+    memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+    
+    char accepted = 0;
+    if (::sendmsg(fd, &msg, MSG_NOSIGNAL) != sizeof(length) ||
+        !socketWrite(fd, payload.constData(), payload.size()) ||
+        !socketRead(fd, &accepted, sizeof(accepted), QDeadlineTimer(AcceptTimeoutMs))) {
+        ::close(fd); // the server drops a request whose client is gone
+        return -1;
+    }
+    qint32 exitCode = 1;
+    if (!socketRead(fd, (char*)&exitCode, sizeof(exitCode)))
+        exitCode = 1; // the server went away while showing the dialog
+    ::close(fd);
+    return exitCode;
+}
+
+// Whether a server listens on socketPath. The connection is closed right away without
+// sending a request, and without waiting for a server that is busy with a dialog.
+static bool isServerListening(const QByteArray &socketPath)
+{
+    sockaddr_un address;
+    if (!socketAddress(socketPath, address))
+        return false;
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+        return false;
+    ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+    const bool listening = ::connect(fd, (sockaddr*)&address, sizeof(address)) == 0 ||
+                           errno == EAGAIN || errno == EINPROGRESS;
+    ::close(fd);
+    return listening;
 }
+#endif
 
 // End of "static functions"
 
@@ -1067,146 +3687,50 @@ static void setTextInfo(QTextEdit *textInfo)
 
 Guid::Guid(int &argc, char **argv) : QApplication(argc, argv),
     m_alwaysOnTop(false),
+    m_clientFd(-1),
     m_closeToSysTray(false),
     m_dialog(NULL),
+    m_formsPage(NULL),
+    m_formsValuesOnly(false),
     m_modal(false),
     m_noTaskbar(false),
-    m_notificationId(0),
+    m_notifier(NULL),
     m_okCommand(""),
     m_okCommandToFooter(false),
+    m_okCoprocess(NULL),
     m_okKeepOpen(false),
     m_okValuesToFooter(false),
+    m_outputFormat(Text),
     m_parentWindow(0),
     m_prefixErr(""),
     m_prefixOk(""),
+    m_requestScope(NULL),
     m_selectableLabel(false),
+    m_serverFd(-1),
+    m_serverNotifier(NULL),
+    m_stdinBatchMs(16),
+    m_stdinClosed(false),
+    m_stdinFormat(Lines),
+    m_stdinTimer(NULL),
     m_sysTray(NULL),
-    m_sysTrayMsg(false),
-    m_timeout(0),
-    m_type(Invalid)
-{
-    QStringList argList = QCoreApplication::arguments(); // arguments() is slow
-    m_zenity = argList.at(0).endsWith("zenity");
-    // make canonical list
-    QStringList args;
-    if (argList.at(0).endsWith("-askpass")) {
-        argList.removeFirst();
-        args << "--title" << tr("Enter Password") << "--password" << "--prompt" << argList.join(' ');
-    } else {
-        for (int i = 1; i < argList.count(); ++i) {
-            if (argList.at(i).startsWith("--")) {
-                int split = argList.at(i).indexOf('=');
-                if (split > -1) {
-                    args << argList.at(i).left(split) << argList.at(i).mid(split+1);
-                } else {
-                    args << argList.at(i);
-                }
-            } else {
-                args << argList.at(i);
-            }
-        }
-    }
-    argList.clear();
-
-    if (!readGeneral(args))
-        return;
-
-    char error = 1;
-    foreach (const QString &arg, args) {
-        if (arg == "--calendar") {
-            m_type = Calendar;
-            error = showCalendar(args);
-        } else if (arg == "--entry") {
-            m_type = Entry;
-            error = showEntry(args);
-        } else if (arg == "--error") {
-            m_type = Error;
-            error = showMessage(args, 'e');
-        } else if (arg == "--info") {
-            m_type = Info;
-            error = showMessage(args, 'i');
-        } else if (arg == "--file-selection") {
-            m_type = FileSelection;
-            error = showFileSelection(args);
-        } else if (arg == "--list") {
-            m_type = List;
-            error = showList(args);
-        } else if (arg == "--notification") {
-            m_type = Notification;
-            error = showNotification(args);
-        } else if (arg == "--progress") {
-            m_type = Progress;
-            error = showProgress(args);
-        } else if (arg == "--question") {
-            m_type = Question;
-            error = showMessage(args, 'q');
-        } else if (arg == "--warning") {
-            m_type = Warning;
-            error = showMessage(args, 'w');
-        } else if (arg == "--scale") {
-            m_type = Scale;
-            error = showScale(args);
-        } else if (arg == "--text-info") {
-            m_type = TextInfo;
-            error = showText(args);
-        } else if (arg == "--color-selection") {
-            m_type = ColorSelection;
-            error = showColorSelection(args);
-        } else if (arg == "--font-selection") {
-            m_type = FontSelection;
-            error = showFontSelection(args);
-        } else if (arg == "--password") {
-            m_type = Password;
-            error = showPassword(args);
-        } else if (arg == "--forms") {
-            m_type = Forms;
-            error = showForms(args);
-        }
-        if (error != 1) {
-            break;
-        }
-    }
-
-    if (error) {
-        QMetaObject::invokeMethod(this, "exitGuid", Qt::QueuedConnection, Q_ARG(int, 2));
-        return;
-    }
-
-    if (m_dialog) {
-        // close on ctrl+return in addition to ctrl+enter
-        QAction *shortAccept = new QAction(m_dialog);
-        m_dialog->addAction(shortAccept);
-        shortAccept->setShortcut(QKeySequence(Qt::CTRL + Qt::Key_Return));
-        connect (shortAccept, SIGNAL(triggered()), m_dialog, SLOT(accept()));
-
-        // workaround for #21 - since QWidget is now merely bitrot, QDialog closes,
-        // but does not reject on the escape key (unlike announced in the specific section of the API)
-        QAction *shortReject = new QAction(m_dialog);
-        m_dialog->addAction(shortReject);
-        shortReject->setShortcut(QKeySequence(Qt::Key_Escape));
-        connect (shortReject, SIGNAL(triggered()), m_dialog, SLOT(reject()));
-        
-        m_dialog->setWindowModality(m_modal ? Qt::ApplicationModal : Qt::NonModal);
-        if (!m_caption.isNull())
-            m_dialog->setWindowTitle(m_caption);
-        if (!m_icon.isNull())
-            m_dialog->setWindowIcon(QIcon(m_icon));
-        QDialogButtonBox *box = m_dialog->findChild<QDialogButtonBox*>();
-        if (box && !m_ok.isNull()) {
-            if (QPushButton *btn = box->button(QDialogButtonBox::Ok))
-                btn->setText(m_ok);
-        }
-        if (box && !m_cancel.isNull()) {
-            if (QPushButton *btn = box->button(QDialogButtonBox::Cancel))
-                btn->setText(m_cancel);
-        }
-        if (m_parentWindow) {
-            #ifdef WS_X11
-                m_dialog->setAttribute(Qt::WA_X11BypassTransientForHint);
-                XSetTransientForHint(QX11Info::display(), m_dialog->winId(), m_parentWindow);
-            #endif
+    m_sysTrayMsg(false),
+    m_timeout(0),
+    m_type(Invalid)
+{
+    QStringList argList = QCoreApplication::arguments(); // arguments() is slow
+    for (int i = 1; i < argList.count(); ++i) {
+        const QString &arg = argList.at(i);
+        if (arg == "--server" || arg.startsWith("--server=")) {
+            QString socketPath = arg.mid(9);
+            if (arg == "--server" && i + 1 < argList.count() && !argList.at(i + 1).startsWith('-'))
+                socketPath = argList.at(i + 1);
+            if (socketPath.isEmpty())
+                socketPath = qEnvironmentVariable("GUID_SERVER");
+            listenToClients(socketPath);
+            return;
         }
     }
+    start(argList);
 }
 
 void Guid::printHelp(const QString &category)
@@ -1270,7 +3794,16 @@ void Guid::printHelp(const QString &category)
         Help("--about",
              tr("About guid")) <<
         Help("--version",
-             tr("Print guid version")));
+             tr("Print guid version")) <<
+        Help("", "") <<
+        
+        Help("--server=SOCKET",
+             tr(R"HEREDOC(Keep running and show the dialogs requested through the Unix socket SOCKET
+(default: $GUID_SERVER). When GUID_SERVER is set, guid forwards its arguments, standard
+streams, working directory and environment to the server and exits with the code of the
+dialog, or runs on its own if no server is listening or the server is showing another
+dialog. Only the user running the server can use it. The display and the locale are the
+ones the server started with)HEREDOC")));
         
         /******************************
          * general
@@ -1295,6 +3828,22 @@ void Guid::printHelp(const QString &category)
         
         Help("--timeout=TIMEOUT",
              tr("Set dialog timeout in seconds")) <<
+        Help("--stdin-batch-ms=MS",
+             tr("Collect lines read from stdin for MS milliseconds before updating the dialog (default: 16)")) <<
+        Help("--stdin-format=lines|nul|lenprefix",
+             tr(R"HEREDOC(Set how list cells, progress and notification lines are delimited on stdin.
+"lines" (default) reads lines, "nul" reads UTF-8 records ended by a NUL byte and
+"lenprefix" reads UTF-8 records preceded by their byte count as a 32-bit big-endian
+integer. Records can contain newlines in both binary formats.)HEREDOC")) <<
+        Help("--output-format=text|nul",
+             tr(R"HEREDOC(Set how the values of lists, forms and file selections are printed.
+"text" (default) joins them with the separator on one line, "nul" ends each
+value with a NUL byte, e.g. for `xargs -0`.)HEREDOC")) <<
+        Help("--trace=FILE",
+             tr(R"HEREDOC(Write the time spent starting up, parsing arguments, building and painting the
+dialog, reading files, URLs and stdin, and reloading watched files to FILE as Chrome
+trace events (load it in Perfetto or chrome://tracing). GUID_TRACE=FILE does the same.
+In server mode, a request is traced on its own unless the server itself is.)HEREDOC")) <<
         Help("--always-on-top",
              tr("Force the dialog to be always on top of other windows")) <<
         Help("--no-taskbar",
@@ -1504,6 +4053,18 @@ Example:
 The list of variables supported is displayed at the beginning of each widget section.)HEREDOC"), "") <<
         Help("", "") <<
         
+        // --forms-spec
+        Help("--forms-spec=/path/to/file",
+             tr(R"HEREDOC(Read options from the file, one per line as on the command line but
+without shell quoting (blank lines and lines starting with # are skipped). The
+parsed options are cached in the user's cache directory and used again as long as
+the file doesn't change. Example of file:
+    --forms
+    # Identity
+    --add-entry=Your name
+    --add-file-selection=buttonText=Select file@Your document)HEREDOC")) <<
+        Help("", "") <<
+        
         // --text
         Help("--text=\"Form label (form description)\"",
              tr("Set the form label (always displayed on top, and bold by default")) <<
@@ -1598,6 +4159,9 @@ variable "verboseTabBar=true". Separators will be added in the output between ta
 fields and the selected tab will be marked with "*".)HEREDOC")) <<
         Help("--tab-selected",
              tr("Mark the tab as selected by default when the dialog is shown")) <<
+        Help("--lazy-tabs",
+             tr(R"HEREDOC(Build the fields of a tab only when the tab is shown for the first time.
+Tabs never shown print their default values.)HEREDOC")) <<
         Help("", "") <<
         
         // --col1 || --col2
@@ -1737,6 +4301,10 @@ To hide the list label, add the variable "hideLabel=true". Example:
              --list-values="v1|v2|v3|v4" --editable)HEREDOC")) <<
         Help("--column-values=Column names separated by |",
              tr("List of column names")) <<
+        Help("--column-types=Types separated by |",
+             tr(R"HEREDOC(How each column sorts when its header is clicked (with "--show-header"):
+"auto" (default, numeric if all values are numbers, natural otherwise), "numeric",
+"natural" (text with numbers compared by value) or "text" (locale collation))HEREDOC")) <<
         Help("--list-values=List values separated by |",
              tr("List values")) <<
         Help("--list-values-from-file=\"[addValue=Value@][monitor=true@][sep=Separator@]Path to file\"",
@@ -1789,6 +4357,9 @@ all columns.)HEREDOC")) <<
         Help("--print-values=selected|all",
              tr(R"HEREDOC(Print selected values (by default) or all values (useful in combination
 with "--editable" to get updated values).)HEREDOC")) <<
+        Help("--print-order=original|view",
+             tr(R"HEREDOC(Print rows in the order of the values given (by default) or as sorted in
+the list)HEREDOC")) <<
         Help("--list-row-separator=SEPARATOR",
              tr("Set output separator character for list rows (default is \"~\")")) <<
         Help("--field-width=WIDTH",
@@ -1881,10 +4452,12 @@ so it doesn't appear in the console (no even as empty value) when user input is
         Help("", "") <<
         
         // --add-qr-code
-        Help("--add-qr-code=\"[addLabel=QR code label@]QR Code text\"",
+        Help("--add-qr-code=\"[addLabel=QR code label@][async=true@]QR Code text\"",
              tr(R"HEREDOC(Add a QR code in forms dialog.
 Note that this widget is not a user input field, so it doesn't appear in the console
-(no even as empty value) when user input is printed.)HEREDOC")) <<
+(no even as empty value) when user input is printed.
+To encode a large QR code without delaying the dialog, add the variable "async=true".
+The code is displayed as soon as it's ready.)HEREDOC")) <<
         Help("--align=left|center|right",
              tr("Set QR code alignment")) <<
         Help("--hide",
@@ -2060,9 +4633,11 @@ is used. Otherwise, it's not a user input field, so it doesn't appear in the con
 (no even as empty value) when user input is printed.)HEREDOC")) <<
         Help("--filename=\"[monitor=true@]Path to file\"",
              tr("Get content from the specified file")) <<
-        Help("--url=URL", tr("Get content from the specified URL (curl must be installed on the system)")) <<
+        Help("--url=URL", tr("Get content from the specified URL")) <<
+        Help("--url-refresh=SECONDS",
+             tr("Reload the URL every SECONDS seconds (the content is kept when the page didn't change)")) <<
         Help("--curl-path=\"Path to curl\"",
-             tr("Set path to the curl binary (default is \"curl\")")) <<
+             tr("Fetch the URL with the curl binary at this path instead of the built-in HTTP client")) <<
         Help("--editable",
              tr("Allow the user to edit text")) <<
         Help("--plain",
@@ -2117,9 +4692,11 @@ Note that this widget is not a user input field, so it doesn't appear in the con
 (no even as empty value) when user input is printed.)HEREDOC")) <<
         Help("--filename=/path/to/file",
              tr("Get content from the specified file")) <<
-        Help("--url=URL", tr("Get content from the specified URL (curl must be installed on the system)")) <<
+        Help("--url=URL", tr("Get content from the specified URL")) <<
+        Help("--url-refresh=SECONDS",
+             tr("Reload the URL every SECONDS seconds (the content is kept when the page didn't change)")) <<
         Help("--curl-path=\"Path to curl\"",
-             tr("Set path to the curl binary (default is \"curl\")")) <<
+             tr("Fetch the URL with the curl binary at this path instead of the built-in HTTP client")) <<
         Help("--field-width=WIDTH",
              tr("Set the field width")) <<
         Help("--field-height=HEIGHT",
@@ -2175,6 +4752,19 @@ to exit. Variables that can be used are the following:
              --action-after-ok-click="$action"
     To convert values to base64 in a format suitable for URL, use the variable/marker
     "GUID_VALUES_BASE64_URL".)HEREDOC")) <<
+        Help(R"HEREDOC(--ok-coprocess="[commandToFooter=true@][queue=N@]
+                  [format=lenprefix|nul|lines@]command name[<>command argument]")HEREDOC",
+             tr(R"HEREDOC(Start the command once and write the values of each click on the OK button
+to its stdin instead of running a command per click. The dialog is kept open.
+  - Records are preceded by their byte count as a 32-bit big-endian integer by
+    default, "format=nul" ends them with a NUL byte and "format=lines" with a newline.
+  - Set "commandToFooter=true" to add the records printed back by the command, in the
+    same format, to the dialog footer. Each one answers the oldest submission still
+    waiting, and "queue" submissions (default: 8) may wait before the next ones are
+    held back.
+  - If the command exits with submissions still waiting, it's started again and they
+    are written again.
+The last of --ok-coprocess and --action-after-ok-click is used.)HEREDOC")) <<
         Help("--no-cancel",
              tr("Hide Cancel button")) <<
         Help("", "") <<
@@ -2256,6 +4846,10 @@ It'll be ignored when parsing arguments. Example:
         
         Help("--column=\"Column name\"",
              tr("Add a column")) <<
+        Help("--column-type=auto|numeric|natural|text",
+             tr(R"HEREDOC(Set how the previous column sorts when its header is clicked: "auto" (default,
+numeric if all values are numbers, natural otherwise), "numeric", "natural" (text with
+numbers compared by value) or "text" (locale collation))HEREDOC")) <<
         Help("--hide-column=NUMBER",
              tr("Hide a specific column")) <<
         Help("--print-column=NUMBER|all",
@@ -2287,11 +4881,16 @@ without user interaction))HEREDOC")) <<
         Help("--print-values=selected|all",
              tr(R"HEREDOC(Print selected values (by default) or all values (useful in combination
 with "--editable" to get updated values).)HEREDOC")) <<
+        Help("--print-order=original|view",
+             tr(R"HEREDOC(Print rows in the order of the values given (by default) or as sorted in
+the list)HEREDOC")) <<
         Help("", "") <<
         
         Help("--mid-search",
              tr(R"HEREDOC(Change list default search function searching for text in the middle, not at the
 beginning)HEREDOC")) <<
+        Help("--search-all-columns",
+             tr("Make --mid-search match the text of every column, not only the first one")) <<
         Help("--field-height=HEIGHT",
              tr("Set the field height")) <<
         Help("--separator=SEPARATOR",
@@ -2347,7 +4946,14 @@ beginning)HEREDOC")) <<
         Help("--auto-kill",
              tr("Kill parent process if Cancel button is pressed")) <<
         Help("--no-cancel",
-             tr("Hide Cancel button")));
+             tr("Hide Cancel button")) <<
+        Help("", "") <<
+        
+        Help("--multi-progress",
+             tr(R"HEREDOC(Show one bar per channel in a single dialog. Stdin lines are prefixed with the
+channel id, e.g. "job3:45" or "job3:#Linking". Bars are added as channels show up
+and the dialog is done when all of them reach 100%. --percentage and --pulsate
+don't apply.)HEREDOC")));
         
         /******************************
          * question
@@ -2408,11 +5014,16 @@ beginning)HEREDOC")) <<
         helpDict["text-info"] = CategoryHelp(tr("Text information options"), HelpList() <<
         Help("--filename=Path to file",
              tr("Get content from the specified file")) <<
+        Help("--paged",
+             tr(R"HEREDOC(Map the file and only read the lines in sight, with a find field (always
+done from 64 MiB, unless --html or --editable is used))HEREDOC")) <<
         Help("", "") <<
         
-        Help("--url=URL", tr("Get content from the specified URL (curl must be installed on the system)")) <<
+        Help("--url=URL", tr("Get content from the specified URL")) <<
+        Help("--url-refresh=SECONDS",
+             tr("Reload the URL every SECONDS seconds (the content is kept when the page didn't change)")) <<
         Help("--curl-path=\"Path to curl\"",
-             tr("Set path to the curl binary (default is \"curl\")")) <<
+             tr("Fetch the URL with the curl binary at this path instead of the built-in HTTP client")) <<
         Help("", "") <<
         
         Help("--checkbox=TEXT",
@@ -2432,6 +5043,8 @@ to guess automatically the format)HEREDOC")) <<
         
         Help("--auto-scroll",
              tr("Auto scroll the text to the end (only when text is captured from stdin)")) <<
+        Help("--max-lines=N",
+             tr("Keep at most N lines, the oldest ones are dropped first (useful to follow long logs from stdin)")) <<
         Help("--no-interaction",
              tr("Do not enable user interaction with the WebView (only when \"--html\" is used)")));
         
@@ -2502,35 +5115,124 @@ to guess automatically the format)HEREDOC")) <<
  * private slots
  ******************************************************************************/
 
-void Guid::addListRow()
+void Guid::acceptClient()
 {
-    QTreeWidget *list = sender()->parent()->findChild<QTreeWidget*>();
-    if (list && list->topLevelItemCount() > 0) {
-        QTreeWidgetItem *firstItem = list->topLevelItem(0);
-        QTreeWidgetItem *newItem = firstItem->clone();
-        list->addTopLevelItem(newItem);
-        list->setCurrentItem(newItem);
-        list->scrollToItem(newItem);
-        for (int i = 0; i < newItem->columnCount(); ++i) {
-            newItem->setText(i, QString());
-        }
-        
-        QWidget *firstItemWidget = list->itemWidget(firstItem, 0);
-        if (firstItemWidget) {
-            if (qstrcmp(firstItemWidget->metaObject()->className(), "QCheckBox") == 0) {
-                QCheckBox *cb = new QCheckBox();
-                cb->setContentsMargins(0, 0, 0, 0);
-                cb->setCheckState(Qt::Unchecked);
-                cb->setStyleSheet("QCheckBox::indicator {subcontrol-position: center center;}");
-                list->setItemWidget(newItem, 0, cb);
-            } else if (qstrcmp(firstItemWidget->metaObject()->className(), "QRadioButton") == 0) {
-                QRadioButton *rb = new QRadioButton();
-                rb->setContentsMargins(0, 0, 0, 0);
-                rb->setChecked(false);
-                rb->setStyleSheet("QRadioButton::indicator {subcontrol-position: center center;}");
-                list->setItemWidget(newItem, 0, rb);
+    #ifdef Q_OS_UNIX
+        if (m_clientFd > -1)
+            return; // one dialog at a time, the other clients soon show theirs in-process
+        const int fd = ::accept(m_serverFd, NULL, NULL);
+        if (fd < 0)
+            return;
+        if (!isSameUser(fd)) {
+            ::close(fd);
+            return;
+        }
+        // The request comes right after connecting, a client that stalls can't hold the server.
+        enum { RequestTimeoutMs = 2000 };
+        const QDeadlineTimer deadline(RequestTimeoutMs);
+    
+        quint32 length = 0;
+        int fds[3] = { -1, -1, -1 };
+        char control[CMSG_SPACE(sizeof(fds))];
+        iovec iov = { &length, sizeof(length) };
+        msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+        const ssize_t n = socketWait(fd, deadline) ? ::recvmsg(fd, &msg, MSG_DONTWAIT) : -1;
+        cmsghdr *cmsg = n > 0 ? CMSG_FIRSTHDR(&msg) : NULL;
+        if (cmsg && cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS &&
+            cmsg->cmsg_len == CMSG_LEN(sizeof(fds)))
+            memcpy(fds, CMSG_DATA(cmsg), sizeof(fds));
+    
+        QByteArray payload;
+        bool valid = n > 0 && fds[0] > -1 && fds[1] > -1 && fds[2] > -1 &&
+                     socketRead(fd, (char*)&length + n, sizeof(length) - n, deadline) && length < 16*1024*1024;
+        if (valid) {
+            payload.resize(length);
+            valid = socketRead(fd, payload.data(), length, deadline);
+        }
+        QList<QByteArray> fields = payload.split('\0');
+        if (!fields.isEmpty())
+            fields.removeLast(); // every string is terminated
+        bool ok = false;
+        const int nbVars = fields.value(2).toInt(&ok);
+        valid = valid && ok && nbVars >= 0 && fields.count() >= 4 + nbVars;
+        // The client falls back to showing the dialog itself when this doesn't arrive in time,
+        // a request it has given up on fails here.
+        const char accepted = 1;
+        valid = valid && socketWrite(fd, &accepted, sizeof(accepted));
+        if (!valid) {
+            for (int i = 0; i < 3; ++i) {
+                if (fds[i] > -1)
+                    ::close(fds[i]);
+            }
+            ::close(fd);
+            return;
+        }
+    
+        m_clientFd = fd;
+        m_serverNotifier->setEnabled(false);
+        fflush(stdout);
+        fflush(stderr);
+        for (int i = 0; i < 3; ++i) {
+            ::dup2(fds[i], i);
+            ::close(fds[i]);
+        }
+        if (::chdir(fields.at(0).constData()) < 0)
+            qWarning().noquote() << "cannot enter" << fields.at(0);
+        gs_parentPid = fields.at(1).toInt();
+        setEnvironment(fields.mid(3, nbVars));
+    
+        QStringList argList;
+        for (int i = 3 + nbVars; i < fields.count(); ++i)
+            argList << QString::fromLocal8Bit(fields.at(i));
+    
+        bool helpMission = argList.count() < 2;
+        if (helpMission)
+            printHelp();
+        for (int i = 1; i < argList.count(); ++i) {
+            if (argList.at(i) == "-h" || argList.at(i).startsWith("--help")) {
+                helpMission = true;
+                printHelp(argList.at(i).mid(7)); // "--help-"
             }
         }
+        if (helpMission) {
+            finishRequest(argList.count() < 2 ? 1 : 0);
+            return;
+        }
+    
+        // A request asking for a trace gets one of its own, unless the whole server is traced.
+        const QString tracePath = TraceSpan::isOn() ? QString() : traceFilePath(argList);
+        if (!tracePath.isEmpty()) {
+            TraceSpan::start(tracePath);
+            gs_requestTrace = TraceSpan::isOn();
+        }
+    
+        start(argList);
+        
+        // The client only reads the exit code from now on, the socket gets readable when it's gone.
+        if (m_clientFd == fd && m_requestScope) {
+            QSocketNotifier *hangup = new QSocketNotifier(fd, QSocketNotifier::Read, m_requestScope);
+            connect(hangup, &QSocketNotifier::activated, m_requestScope, [=]() {
+                hangup->setEnabled(false);
+                QMetaObject::invokeMethod(this, "exitGuid", Qt::QueuedConnection, Q_ARG(int, 1));
+            });
+        }
+    #endif
+}
+
+void Guid::addListRow()
+{
+    QTreeView *list = sender()->parent()->findChild<QTreeView*>();
+    ListModel *model = listModel(list);
+    if (model && model->rowCount() > 0) {
+        model->appendRow();
+        int newRow = model->rowCount() - 1;
+        list->setCurrentIndex(listViewIndex(list, model->index(newRow, 0)));
+        list->scrollTo(listViewIndex(list, model->index(newRow, 0)));
     }
 }
 
@@ -2538,10 +5240,13 @@ void Guid::afterTabBarClick(int i)
 {
     QDialog *dlg = static_cast<QDialog*>(m_dialog);
     if (dlg) {
+        QTabWidget *tabBar = static_cast<QTabWidget*>(sender());
+        // Tabs selected while the dialog is built are handled once it's shown.
+        if (tabBar && tabBar->window() == dlg)
+            buildTabPage(tabBar->widget(i));
         QPushButton *buttons = dlg->findChild<QPushButton*>();
         if (buttons) {
             bool disableButtons = false;
-            QTabWidget *tabBar = static_cast<QTabWidget*>(sender());
             if (tabBar) {
                 disableButtons = tabBar->widget(i)->property("guid_tab_disable_buttons").toBool();
             }
@@ -2631,7 +5336,7 @@ void Guid::afterMenuClick()
         QSystemTrayIcon *sysTrayIcon = static_cast<QSystemTrayIcon*>(m_sysTray);
         if (sysTrayIcon)
             sysTrayIcon->hide();
-        exit(menuItemExitCode);
+        exitGuid(menuItemExitCode);
     }
 }
 
@@ -2653,7 +5358,7 @@ void Guid::dialogFinished(int status)
     if (!(status == QDialog::Accepted || status == QMessageBox::Ok || status == QMessageBox::Yes)) {
         #ifdef Q_OS_UNIX
             if (sender()->property("guid_autokill_parent").toBool()) {
-                ::kill(getppid(), 15);
+                ::kill(gs_parentPid ? gs_parentPid : getppid(), 15);
             }
         #endif
         bool minimize = false;
@@ -2704,8 +5409,10 @@ void Guid::dialogFinished(int status)
             break;
         }
         case FileSelection: {
-            QStringList files = static_cast<QFileDialog*>(sender())->selectedFiles();
-            qOut << m_prefixOk + files.join(sender()->property("guid_separator").toString()) << Qt::endl;
+            OutputWriter out(m_prefixOk, sender()->property("guid_separator").toString(), m_outputFormat == NulTerminated);
+            foreach (const QString &file, static_cast<QFileDialog*>(sender())->selectedFiles())
+                out.add(file);
+            out.finish();
             break;
         }
         case ColorSelection: {
@@ -2755,9 +5462,10 @@ void Guid::dialogFinished(int status)
             break;
         }
         case List: {
-            QTreeWidget *tw = sender()->findChild<QTreeWidget*>();
-            QStringList result;
-            if (tw) {
+            QTreeView *tw = sender()->findChild<QTreeView*>();
+            const ListModel *model = listModel(tw);
+            OutputWriter out(m_prefixOk, sender()->property("guid_separator").toString(), m_outputFormat == NulTerminated);
+            if (model) {
                 if (tw->selectionMode() == QAbstractItemView::NoSelection)
                     break;
                 
@@ -2765,31 +5473,19 @@ void Guid::dialogFinished(int status)
                 QString printColumn = tw->property("guid_list_print_column").toString();
                 QString printMode = tw->property("guid_list_print_values_mode").toString();
                 QString selectionType = tw->property("guid_list_selection_type").toString();
-                QList<QTreeWidgetItem*> itemsToCheck;
+                QList<int> rowsToCheck;
                 
-                if (selectionType == "checklist" || selectionType == "radiolist" || printMode == "all") {
-                    for (int i = 0; i < tw->topLevelItemCount(); ++i) {
-                        QTreeWidgetItem *item = tw->topLevelItem(i);
-                        itemsToCheck << item;
-                    }
-                } else {
-                    itemsToCheck = tw->selectedItems();
-                }
+                rowsToCheck = listOutputRows(tw, selectionType == "checklist" || selectionType == "radiolist" ||
+                                                 printMode == "all");
                 
                 if (selectionType == "checklist" || selectionType == "radiolist") {
                     bool isChecked = false;
-                    foreach (QTreeWidgetItem *twi, itemsToCheck) {
-                        if (selectionType == "checklist") {
-                            QCheckBox *cb = qobject_cast<QCheckBox*>(tw->itemWidget(twi, 0));
-                            isChecked = cb->isChecked();
-                        } else if (selectionType == "radiolist") {
-                            QRadioButton *rb = qobject_cast<QRadioButton*>(tw->itemWidget(twi, 0));
-                            isChecked = rb->isChecked();
-                        }
+                    foreach (int row, rowsToCheck) {
+                        isChecked = model->isChecked(row);
                         
                         if (isChecked || printMode == "all") {
                             rowValue = "";
-                            for (int i = 0; i < tw->columnCount(); ++i) {
+                            for (int i = 0; i < model->columnCount(); ++i) {
                                 if (printColumn == "all" || printColumn == QString::number(i + 1)) {
                                     if (i > 0)
                                         rowValue += ',';
@@ -2800,28 +5496,28 @@ void Guid::dialogFinished(int status)
                                         else
                                             rowValue += "false";
                                     } else {
-                                        rowValue += twi->text(i);
+                                        rowValue += model->text(row, i);
                                     }
                                 }
                             }
-                            result << rowValue;
+                            out.add(rowValue);
                         }
                     }
                 } else {
-                    foreach (QTreeWidgetItem *twi, itemsToCheck) {
+                    foreach (int row, rowsToCheck) {
                         rowValue = "";
-                        for (int i = 0; i < tw->columnCount(); ++i) {
+                        for (int i = 0; i < model->columnCount(); ++i) {
                             if (printColumn == "all" || printColumn == QString::number(i + 1)) {
                                 if (i > 0)
                                     rowValue += ',';
-                                rowValue += twi->text(i);
+                                rowValue += model->text(row, i);
                             }
                         }
-                        result << rowValue;
+                        out.add(rowValue);
                     }
                 }
             }
-            qOut << m_prefixOk + result.join(sender()->property("guid_separator").toString()) << Qt::endl;
+            out.finish();
             break;
         }
         case Forms: {
@@ -2845,6 +5541,14 @@ void Guid::exitGuid(int exitCode, bool minimize)
         qtimer->singleShot(10, this, SLOT(minimizeDialog()));
         qtimer->deleteLater();
     } else {
+        if (m_okCoprocess)
+            m_okCoprocess->finish();
+        if (m_serverFd > -1) {
+            // Server mode: hand the exit code to the client and wait for the next one.
+            if (m_clientFd > -1)
+                finishRequest(exitCode);
+            return;
+        }
         QSystemTrayIcon *sysTrayIcon = static_cast<QSystemTrayIcon*>(m_sysTray);
         if (sysTrayIcon)
             sysTrayIcon->hide();
@@ -2855,10 +5559,9 @@ void Guid::exitGuid(int exitCode, bool minimize)
 void Guid::finishProgress()
 {
     Q_ASSERT(m_type == Progress);
-    QProgressDialog *dlg = static_cast<QProgressDialog*>(m_dialog);
-    if (dlg->property("guid_autoclose").toBool())
-        QTimer::singleShot(250, this, SLOT(quitDialog()));
-    else {
+    if (m_dialog->property("guid_autoclose").toBool()) {
+        QTimer::singleShot(250, m_requestScope, [this]() { quitDialog(); });
+    } else if (QProgressDialog *dlg = qobject_cast<QProgressDialog*>(m_dialog)) {
         dlg->setRange(0, 101);
         dlg->setValue(100);
         disconnect (dlg, SIGNAL(canceled()), dlg, SLOT(reject()));
@@ -2866,17 +5569,22 @@ void Guid::finishProgress()
         dlg->setCancelButtonText(m_ok.isNull() ? tr("Ok") : m_ok);
         if (QPushButton *btn = dlg->findChild<QPushButton*>())
             btn->show();
+    } else if (QDialogButtonBox *btns = m_dialog->findChild<QDialogButtonBox*>()) {
+        // --multi-progress
+        btns->setStandardButtons(QDialogButtonBox::Ok);
+        btns->button(QDialogButtonBox::Ok)->setText(m_ok.isNull() ? tr("Ok") : m_ok);
+        btns->show();
     }
 }
 
 void Guid::listMenu(const QPoint &pos)
 {
-    QTreeWidget *tw = static_cast<QTreeWidget*>(sender());
+    QTreeView *tw = static_cast<QTreeView*>(sender());
     if (!tw)
         return;
     
-    QTreeWidgetItem *twi = tw->itemAt(pos);
-    if (!twi)
+    QModelIndex index = tw->indexAt(pos);
+    if (!index.isValid())
         return;
     
     QMenu *menu = new QMenu();
@@ -2886,10 +5594,10 @@ void Guid::listMenu(const QPoint &pos)
     actionCopy->setIcon(actionIcon);
     connect(actionCopy, &QAction::triggered, [=]() {
         QString newClipContent = "";
-        for (int i = 0; i < twi->columnCount(); ++i) {
+        for (int i = 0; i < tw->model()->columnCount(); ++i) {
             if (!newClipContent.isEmpty())
                 newClipContent += ",";
-            newClipContent += twi->text(i);
+            newClipContent += index.sibling(index.row(), i).data().toString();
         }
         
         if (!newClipContent.isEmpty()) {
@@ -2928,24 +5636,24 @@ void Guid::printFormsAfterOKClick()
     bool ok;
     
     // Print current forms values
-    QString values = printForms();
+    QString values = printForms((m_okValuesToFooter && footer) || m_okCoprocess || !m_okCommand.isEmpty());
     if (m_okValuesToFooter && footer)
-        updateFooterContent(footer, values);
+        updateFooterContent(footer, QStringList(values));
     
     // Clear forms values
     
-    QList<QLineEdit*> entries = dialog->findChildren<QLineEdit*>();
+    QList<QLineEdit*> entries = dialogWidgets<QLineEdit>();
     foreach(QLineEdit *entry, entries) {
         entry->clear();
     }
     
-    QList<QTextEdit*> textEntries = dialog->findChildren<QTextEdit*>();
+    QList<QTextEdit*> textEntries = dialogWidgets<QTextEdit>();
     foreach(QTextEdit *textEntry, textEntries) {
         if (!textEntry->isReadOnly())
             textEntry->clear();
     }
     
-    QList<QCheckBox*> cb = dialog->findChildren<QCheckBox*>();
+    QList<QCheckBox*> cb = dialogWidgets<QCheckBox>();
     foreach(QCheckBox *cbi, cb) {
         if (cbi->property("guid_checkbox_default").toString() == "checked")
             cbi->setCheckState(Qt::Checked);
@@ -2953,7 +5661,7 @@ void Guid::printFormsAfterOKClick()
             cbi->setCheckState(Qt::Unchecked);
     }
     
-    QList<QComboBox*> combos = dialog->findChildren<QComboBox*>();
+    QList<QComboBox*> combos = dialogWidgets<QComboBox>();
     foreach(QComboBox *combo, combos) {
         int defaultComboIndex = combo->property("guid_combo_default_index").toInt(&ok);
         if (ok && defaultComboIndex >= 0 && defaultComboIndex < combo->count())
@@ -2962,7 +5670,7 @@ void Guid::printFormsAfterOKClick()
             combo->setCurrentIndex(-1);
     }
     
-    QList<QSlider*> scales = dialog->findChildren<QSlider*>();
+    QList<QSlider*> scales = dialogWidgets<QSlider>();
     foreach(QSlider *scale, scales) {
         int defaultScaleValue = scale->property("guid_scale_default").toInt(&ok);
         if (ok && defaultScaleValue != INT_MIN)
@@ -2971,7 +5679,7 @@ void Guid::printFormsAfterOKClick()
             scale->setValue(scale->minimum());
     }
     
-    QList<QSpinBox*> spinBoxes = dialog->findChildren<QSpinBox*>();
+    QList<QSpinBox*> spinBoxes = dialogWidgets<QSpinBox>();
     foreach(QSpinBox *spinBox, spinBoxes) {
         int defaultSpinBoxValue = spinBox->property("guid_spin_box_default").toInt(&ok);
         if (ok && defaultSpinBoxValue != INT_MIN)
@@ -2980,7 +5688,7 @@ void Guid::printFormsAfterOKClick()
             spinBox->setValue(spinBox->minimum());
     }
     
-    QList<QDoubleSpinBox*> doubleSpinBoxes = dialog->findChildren<QDoubleSpinBox*>();
+    QList<QDoubleSpinBox*> doubleSpinBoxes = dialogWidgets<QDoubleSpinBox>();
     foreach(QDoubleSpinBox *doubleSpinBox, doubleSpinBoxes) {
         int defaultDoubleSpinBoxValue = doubleSpinBox->property("guid_double_spin_box_default").toDouble(&ok);
         if (ok && defaultDoubleSpinBoxValue != -DBL_MAX)
@@ -2989,13 +5697,15 @@ void Guid::printFormsAfterOKClick()
             doubleSpinBox->setValue(doubleSpinBox->minimum());
     }
     
-    QList<QTreeWidget*> tw = dialog->findChildren<QTreeWidget*>();
-    foreach(QTreeWidget *twi, tw) {
+    QList<QTreeView*> tw = dialogWidgets<QTreeView>();
+    foreach(QTreeView *twi, tw) {
         twi->clearSelection();
     }
     
     // Run command
-    if (!m_okCommand.isEmpty()) {
+    if (m_okCoprocess) {
+        m_okCoprocess->submit(values);
+    } else if (!m_okCommand.isEmpty()) {
         QString command = m_okCommand;
         if (command.contains("GUID_VALUES_BASE64_URL")) {
             values = values.toUtf8().toBase64(QByteArray::Base64UrlEncoding|QByteArray::OmitTrailingEquals);
@@ -3016,7 +5726,7 @@ void Guid::printFormsAfterOKClick()
         if (m_okCommandToFooter && footer) {
             connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), [=]() {
                 QString commandOutput = QString::fromLocal8Bit(process->readAllStandardOutput());
-                updateFooterContent(footer, commandOutput.trimmed());
+                updateFooterContent(footer, QStringList(commandOutput.trimmed()));
                 
                 delete process;
             });
@@ -3036,58 +5746,111 @@ void Guid::printInteger(int v)
     qOut << m_prefixOk + QString::number(v);
 }
 
-void Guid::quitDialog()
-{
-    exitGuid(0);
-}
-
-void Guid::readStdIn()
+void Guid::processStdIn()
 {
     QOUT_ERR
-    if (!gs_stdin->isOpen())
-        return;
-    QSocketNotifier *notifier = qobject_cast<QSocketNotifier*>(sender());
-    if (notifier)
-        notifier->setEnabled(false);
-
-    QByteArray ba = m_type == TextInfo ? gs_stdin->readAll() : gs_stdin->readLine();
-    if (ba.isEmpty() && notifier) {
-        gs_stdin->close();
-        //gs_stdin->deleteLater(); // hello segfault...
-        //gs_stdin = NULL;
-        notifier->deleteLater();
-        return;
-    }
-
-    static QString cachedText;
-    QString newText = QString::fromLocal8Bit(ba);
-    if (newText.isEmpty() && cachedText.isEmpty()) {
-        if (notifier)
-            notifier->setEnabled(true);
-        return;
-    }
-
+    TraceSpan span("processStdIn");
+    span.arg("bytes", m_stdinBuffer.size());
+    QString newText;
     QStringList input;
-    if (m_type != TextInfo) {
-        if (newText.endsWith('\n'))
-            newText.resize(newText.length()-1);
-        input = newText.split('\n');
+    if (m_type == TextInfo) {
+        newText = QString::fromLocal8Bit(m_stdinBuffer);
+        m_stdinBuffer.clear();
+        if (newText.isEmpty() && m_stdinText.isEmpty())
+            return;
+    } else {
+        // Parse the whole batch at once, an incomplete last record waits for the next one.
+        bool invalid = false;
+        const int length = readStdInRecords(m_stdinBuffer, m_stdinFormat, m_stdinClosed, input, &invalid);
+        m_stdinBuffer.remove(0, length);
+        span.arg("records", input.count());
+        if (invalid) {
+            // The framing is lost, whatever comes next can't be read.
+            qOutErr << m_prefixErr + "stdin: record length out of range, ignoring the rest of the input" << Qt::endl;
+            if (QSocketNotifier *notifier = gs_stdin->findChild<QSocketNotifier*>())
+                notifier->setEnabled(false);
+            m_stdinClosed = true;
+            m_stdinBuffer.clear();
+        } else if (m_stdinClosed && !m_stdinBuffer.isEmpty()) {
+            qOutErr << m_prefixErr + QString("stdin: input ends inside a record, %1 bytes ignored")
+                       .arg(m_stdinBuffer.size()) << Qt::endl;
+            m_stdinBuffer.clear();
+        }
+        if (input.isEmpty() && !(m_stdinClosed && m_type == List && !m_stdinCells.isEmpty()))
+            return;
     }
-    if (m_type == Progress) {
-        QProgressDialog *dlg = static_cast<QProgressDialog*>(m_dialog);
-
-        const int oldValue = dlg->value();
-        bool ok;
-        foreach (QString line, input) {
-            if (line.startsWith('#')) {
-                dlg->setLabelText(labelText(line.mid(1)));
+    
+    if (m_type == Progress && m_dialog->property("guid_multi_progress").toBool()) {
+        QDialog *dlg = m_dialog;
+        QFormLayout *channels = dlg->findChild<QFormLayout*>();
+        
+        // Lines are "channel:percentage" or "channel:#label". Sorting them by channel first
+        // leaves a single update per bar and batch.
+        QStringList order;
+        QHash<QString, QStringList> channelLines;
+        foreach (const QString &line, input) {
+            const int split = line.indexOf(':');
+            if (split < 1)
+                continue;
+            const QString channel = line.left(split);
+            if (!channelLines.contains(channel))
+                order << channel;
+            channelLines[channel] << line.mid(split + 1);
+        }
+        
+        foreach (const QString &channel, order) {
+            QString label;
+            bool hasLabel;
+            int value;
+            readProgressLines(channelLines.value(channel), label, hasLabel, value);
+            
+            QProgressBar *bar = dlg->findChild<QProgressBar*>("guid_channel_" + channel);
+            QLabel *channelLabel;
+            if (bar) {
+                channelLabel = static_cast<QLabel*>(channels->labelForField(bar));
             } else {
-                static const QRegularExpression nondigit("[^0-9]");
-                int u = line.section(nondigit,0,0).toInt(&ok);
-                if (ok)
-                    dlg->setValue(qMin(100,u));
+                channelLabel = new QLabel(channel, dlg);
+                bar = new QProgressBar(dlg);
+                bar->setObjectName("guid_channel_" + channel);
+                bar->setRange(0, 100);
+                bar->setValue(0);
+                channels->addRow(channelLabel, bar);
+            }
+            if (hasLabel)
+                channelLabel->setText(labelText(label));
+            if (value > -1)
+                bar->setValue(value);
+            if (dlg->property("guid_eta").toBool() && bar->value() < 100)
+                updateProgressEta(bar, bar->value(), QList<QWidget*>() << channelLabel << bar);
+        }
+        
+        bool done = channels->rowCount() > 0;
+        foreach (QProgressBar *bar, dlg->findChildren<QProgressBar*>()) {
+            if (bar->value() < 100)
+                done = false;
+        }
+        const bool wasDone = dlg->property("guid_multi_progress_done").toBool();
+        dlg->setProperty("guid_multi_progress_done", done);
+        if (done && !wasDone) {
+            finishProgress();
+        } else if (!done && wasDone) {
+            if (QDialogButtonBox *btns = dlg->findChild<QDialogButtonBox*>()) {
+                btns->setStandardButtons(QDialogButtonBox::Cancel);
+                btns->button(QDialogButtonBox::Cancel)->setText(m_cancel.isNull() ? tr("Cancel") : m_cancel);
             }
         }
+    } else if (m_type == Progress) {
+        QProgressDialog *dlg = static_cast<QProgressDialog*>(m_dialog);
+
+        const int oldValue = dlg->value();
+        QString label;
+        bool hasLabel;
+        int value;
+        readProgressLines(input, label, hasLabel, value);
+        if (hasLabel)
+            dlg->setLabelText(labelText(label));
+        if (value > -1)
+            dlg->setValue(value);
 
         if (dlg->maximum() == 0)
             return; // we just need the label support
@@ -3099,33 +5862,34 @@ void Guid::readStdIn()
             connect (dlg, SIGNAL(canceled()), dlg, SLOT(reject()));
             dlg->setCancelButtonText(m_cancel.isNull() ? tr("Cancel") : m_cancel);
         } else if (dlg->property("guid_eta").toBool()) {
-            static QDateTime starttime;
-            if (starttime.isNull()) {
-                starttime = QDateTime::currentDateTime();
-            } else if (dlg->value() > 0) {
-                const qint64 secs = starttime.secsTo(QDateTime::currentDateTime());
-                QString eta = QTime(0,0,0).addSecs(100 * secs / dlg->value() - secs).toString();
-                foreach (QWidget *w, dlg->findChildren<QWidget*>())
-                    w->setToolTip(eta);
-            }
+            updateProgressEta(dlg, dlg->value(), dlg->findChildren<QWidget*>());
         }
     } else if (m_type == TextInfo) {
-        if (QTextEdit *te = m_dialog->findChild<QTextEdit*>()) {
-            cachedText += newText;
-            static QPropertyAnimation *animator = NULL;
+        if (QTextEdit *te = dialogWidget<QTextEdit>()) {
+            m_stdinText += newText;
+            // Owned by the scroll bar, so it goes away with the dialog.
+            static QPointer<QPropertyAnimation> animator;
             if (!animator || animator->state() != QPropertyAnimation::Running) {
                 const int oldValue = te->verticalScrollBar() ? te->verticalScrollBar()->value() : 0;
-                if (te->property("guid_html").toBool())
-                    te->setHtml(te->toHtml() + cachedText);
-                else
-                    te->setPlainText(te->toPlainText() + cachedText);
-                cachedText.clear();
+                // Append at the end instead of resetting the document, the existing
+                // content is neither serialized nor laid out again.
+                QTextCursor cursor(te->document());
+                cursor.movePosition(QTextCursor::End);
+                if (te->property("guid_html").toBool()) {
+                    // Don't feed half a tag to the parser.
+                    const int split = m_stdinClosed ? m_stdinText.length() : m_stdinText.lastIndexOf('\n') + 1;
+                    cursor.insertHtml(m_stdinText.left(split));
+                    m_stdinText.remove(0, split);
+                } else {
+                    cursor.insertText(m_stdinText);
+                    m_stdinText.clear();
+                }
                 if (te->verticalScrollBar() && te->property("guid_autoscroll").toBool()) {
                     te->verticalScrollBar()->setValue(oldValue);
                     if (!animator) {
-                        animator = new QPropertyAnimation(te->verticalScrollBar(), "value", this);
+                        animator = new QPropertyAnimation(te->verticalScrollBar(), "value", te->verticalScrollBar());
                         animator->setEasingCurve(QEasingCurve::InOutCubic);
-                        connect(animator, SIGNAL(finished()), SLOT(readStdIn()));
+                        connect(animator, SIGNAL(finished()), this, SLOT(processStdIn()));
                     }
                     const int diff = te->verticalScrollBar()->maximum() - oldValue;
                     if (diff > 0) {
@@ -3163,13 +5927,74 @@ void Guid::readStdIn()
         if (userNeedsHelp)
             qOutErr << m_prefixErr + "icon: <filename>\nmessage: <UTF-8 encoded text>\ntooltip: <UTF-8 encoded text>\nvisible: <true|false>" << Qt::endl;
     } else if (m_type == List) {
-        if (QTreeWidget *tw = m_dialog->findChild<QTreeWidget*>()) {
-            const int twflags = tw->property("guid_list_flags").toInt();
-            addItems(tw, input, twflags & 1, twflags & 1<<1, twflags & 1<<2);
+        if (QTreeView *tw = dialogWidget<QTreeView>()) {
+            // Every line is a cell: hold back an incomplete row until its last cell arrives.
+            const int columns = qMax(1, tw->model()->columnCount());
+            m_stdinCells << input;
+            QStringList cells = m_stdinCells;
+            m_stdinCells.clear();
+            if (!m_stdinClosed) {
+                const int pending = cells.count() % columns;
+                m_stdinCells = cells.mid(cells.count() - pending);
+                cells.erase(cells.end() - pending, cells.end());
+            }
+            if (!cells.isEmpty())
+                addItems(tw, cells);
+        }
+    }
+}
+
+void Guid::quitDialog()
+{
+    exitGuid(0);
+}
+
+void Guid::readStdIn()
+{
+    if (!gs_stdin->isOpen())
+        return;
+    QSocketNotifier *notifier = qobject_cast<QSocketNotifier*>(sender());
+    
+    // Drain what the producer has written so far and leave the parsing to
+    // processStdIn(), which runs at most once per --stdin-batch-ms.
+    bool atEnd = false;
+    #ifdef Q_OS_UNIX
+        char buffer[65536];
+        forever {
+            const ssize_t n = ::read(gs_stdin->handle(), buffer, sizeof(buffer));
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0) {
+                atEnd = true;
+                break;
+            }
+            m_stdinBuffer.append(buffer, n);
+            // Don't starve the event loop on an endless stream.
+            if (n < (ssize_t)sizeof(buffer) || m_stdinBuffer.size() > 4*1024*1024)
+                break;
+            struct pollfd pfd = { gs_stdin->handle(), POLLIN, 0 };
+            if (::poll(&pfd, 1, 0) < 1)
+                break;
         }
+    #else
+        QByteArray ba = m_type == TextInfo ? gs_stdin->readAll() : gs_stdin->readLine();
+        atEnd = ba.isEmpty();
+        m_stdinBuffer += ba;
+    #endif
+    
+    if (atEnd && notifier) {
+        m_stdinClosed = true;
+        m_stdinTimer->stop();
+        processStdIn();
+        gs_stdin->close();
+        //gs_stdin->deleteLater(); // hello segfault...
+        //gs_stdin = NULL;
+        notifier->deleteLater();
+        return;
     }
-    if (notifier)
-        notifier->setEnabled(true);
+    
+    if (!m_stdinTimer->isActive())
+        m_stdinTimer->start(m_stdinBatchMs);
 }
 
 void Guid::showDialog()
@@ -3191,21 +6016,23 @@ void Guid::showSysTrayMenu(QSystemTrayIcon::ActivationReason reason)
     }
 }
 
-void Guid::toggleItems(QTreeWidgetItem *item, int column)
+void Guid::toggleItems(const QModelIndex &index)
 {
-    if (column)
+    if (index.column())
         return; // not the checkmark
+    if (index.data(Qt::CheckStateRole).toInt() != Qt::Checked)
+        return;
 
     static bool recursion = false;
     if (recursion)
         return;
 
     recursion = true;
-    QTreeWidget *tw = item->treeWidget();
-    for (int i = 0; i < tw->topLevelItemCount(); ++i) {
-        QTreeWidgetItem *twi = tw->topLevelItem(i);
-        if (twi != item)
-            twi->setCheckState(0, Qt::Unchecked);
+    QAbstractItemModel *model = const_cast<QAbstractItemModel*>(index.model());
+    for (int i = 0; i < model->rowCount(); ++i) {
+        QModelIndex other = model->index(i, 0);
+        if (i != index.row() && other.data(Qt::CheckStateRole).toInt() == Qt::Checked)
+            model->setData(other, Qt::Unchecked, Qt::CheckStateRole);
     }
     recursion = false;
 }
@@ -3215,16 +6042,23 @@ void Guid::updateCombo(QString filePath)
     if (!QFile::exists(filePath))
         return;
     
-    foreach (QComboBox *combo, sender()->parent()->findChildren<QComboBox*>()) {
+    foreach (QComboBox *combo, fileWidgets<QComboBox>(filePath)) {
         if (combo->property("guid_monitor_file").toBool() && combo->property("guid_file_path").toString() == filePath) {
-            combo->clear();
-            GList list = listValuesFromFile(filePath);
-            combo->addItems(list.val);
-            bool ok;
-            int currentIndex = combo->property("guid_combo_default_index").toInt(&ok);
-            if (ok && currentIndex > 0 && currentIndex < combo->count()) {
-                combo->setCurrentIndex(currentIndex);
-            }
+            if (!fileStampChanged(combo, filePath))
+                continue;
+            QString fileSep = combo->property("guid_file_sep").toString();
+            if (fileSep.isEmpty())
+                fileSep = "\n";
+            loadInBackground<QStringList>(combo, [=]() { return readFileLines(filePath, fileSep); },
+                                          [=](const QStringList &values) {
+                const bool wasEmpty = !combo->count();
+                updateComboItems(combo, values);
+                bool ok;
+                int currentIndex = combo->property("guid_combo_default_index").toInt(&ok);
+                if (wasEmpty && ok && currentIndex > 0 && currentIndex < combo->count()) {
+                    combo->setCurrentIndex(currentIndex);
+                }
+            });
         }
     }
 }
@@ -3247,110 +6081,46 @@ void Guid::updateFooter(QString filePath)
 
 void Guid::updateList(QString filePath)
 {
-    // The file containing list values has been updated. However, the way it was edited is not known.
-    // Some editors delete the file (event "IN_DELETE_SELF") to replace it with new content, so the
-    // watcher will stop monitoring the file. Here's the workaround: wait some time before testing if
-    // the file exists, then add it again to the watcher.
-    bool pathExists = pathTester(filePath);
-    if (!pathExists)
-        return;
-    QFileSystemWatcher *watcher = static_cast<QFileSystemWatcher*>(sender());
-    watcher->addPath(filePath);
-    
-    foreach (QTreeWidget *tw, watcher->parent()->findChildren<QTreeWidget*>()) {
+    // FileWatcher already waited for editors replacing the file and watches it again.
+    foreach (QTreeView *tw, fileWidgets<QTreeView>(filePath)) {
+        ListModel *model = listModel(tw);
         bool propMonitorFile = tw->property("guid_monitor_file").toBool();
         QString propFilePath = tw->property("guid_file_path").toString();
-        QString propSelectionType = tw->property("guid_list_selection_type").toString();
         QString propAddValue = tw->property("guid_list_add_value").toString();
         QString propFileSep = tw->property("guid_file_sep").toString();
         
-        if (propMonitorFile && propFilePath == filePath) {
-            int columnCount = tw->columnCount();
-            Qt::ItemFlags flags = tw->topLevelItem(0)->flags();
-            tw->clear();
-            
-            QString fileArg = "";
-            if (!propAddValue.isEmpty())
-                fileArg += "addValue=" + propAddValue + "@";
-            if (!propFileSep.isEmpty())
-                fileArg += "sep=" + propFileSep + "@";
-            fileArg += filePath;
-            GList list = listValuesFromFile(fileArg);
-            list.val = addColumnToListValues(list.val, list.addValue, columnCount);
-            for (int i = 0; i < list.val.count(); ) {
-                QStringList itemValues;
-                for (int j = 0; j < columnCount; ++j) {
-                    itemValues << list.val.at(i++);
-                    if (i == list.val.count())
-                        break;
-                }
-                QTreeWidgetItem *item = new QTreeWidgetItem(tw, itemValues);
-                tw->addTopLevelItem(item);
-                
-                flags |= item->flags();
-                item->setFlags(flags);
-                item->setTextAlignment(0, Qt::AlignLeft);
+        if (model && propMonitorFile && propFilePath == filePath) {
+            if (!fileStampChanged(tw, filePath))
+                continue;
+            if (propFileSep.isEmpty())
+                propFileSep = "\n";
+            
+            loadInBackground<QStringList>(tw, [=]() { return readFileLines(filePath, propFileSep); },
+                                          [=](const QStringList &values) {
+                int columnCount = model->columnCount();
+                model->updateValues(addColumnToListValues(values, propAddValue, columnCount));
                 
-                if (propSelectionType == "checklist") {
-                    QCheckBox *cb = new QCheckBox();
-                    cb->setContentsMargins(0, 0, 0, 0);
-                    if (itemValues.at(0).toLower() == "true")
-                        cb->setCheckState(Qt::Checked);
-                    else
-                        cb->setCheckState(Qt::Unchecked);
-                    cb->setStyleSheet("QCheckBox::indicator {subcontrol-position: center center;}");
-                    tw->setItemWidget(item, 0, cb);
-                } else if (propSelectionType == "radiolist") {
-                    QRadioButton *rb = new QRadioButton();
-                    rb->setContentsMargins(0, 0, 0, 0);
-                    if (itemValues.at(0).toLower() == "true")
-                        rb->setChecked(true);
-                    else
-                        rb->setChecked(false);
-                    rb->setStyleSheet("QRadioButton::indicator {subcontrol-position: center center;}");
-                    tw->setItemWidget(item, 0, rb);
+                for (int i = 0; i < columnCount; ++i) {
+                    tw->resizeColumnToContents(i);
                 }
-                
-                if (!propSelectionType.isEmpty())
-                    item->setText(0, QString());
-            }
-            
-            for (int i = 0; i < columnCount; ++i) {
-                tw->resizeColumnToContents(i);
-            }
+            });
         }
     }
 }
 
 void Guid::updateText(QString filePath)
 {
-    bool pathExists = pathTester(filePath);
-    if (!pathExists)
-        return;
-    QFileSystemWatcher *watcher = static_cast<QFileSystemWatcher*>(sender());
-    watcher->addPath(filePath);
-    
-    foreach (QLabel *l, watcher->parent()->findChildren<QLabel*>()) {
-        for (int i = 1; i < 10; ++i) {
-            QString propMarkerFile = "guid_text_monitor_marker_file_" + QString::number(i);
-            if (l->property(propMarkerFile.toStdString().c_str()).toString() == filePath) {
-                setText(l);
-            }
-        }
-    }
+    // Parse the file again once, every label subscribed to it reads the cached result.
+    gs_markerFiles.remove(filePath);
+    foreach (QLabel *l, fileWidgets<QLabel>(filePath))
+        setText(l);
 }
 
 void Guid::updateTextInfo(QString filePath)
 {
-    bool pathExists = pathTester(filePath);
-    if (!pathExists)
-        return;
-    QFileSystemWatcher *watcher = static_cast<QFileSystemWatcher*>(sender());
-    watcher->addPath(filePath);
-    
-    foreach (QTextEdit *ti, watcher->parent()->findChildren<QTextEdit*>()) {
+    foreach (QTextEdit *ti, fileWidgets<QTextEdit>(filePath)) {
         if (ti->property("guid_text_filename").toString() == filePath && ti->property("guid_text_monitor_file").toBool()) {
-            setTextInfo(ti);
+            setTextInfo(ti, true);
         }
     }
 }
@@ -3361,19 +6131,80 @@ void Guid::updateTextInfo(QString filePath)
  * private (1 of 2): misc.
  ******************************************************************************/
 
-void Guid::createQRCode(QLabel *label, QString text)
+void Guid::buildTabPage(QWidget *page)
 {
-    qrcodegen::QrCode qrCode = qrcodegen::QrCode::encodeText(text.toUtf8().data(), qrcodegen::QrCode::Ecc::HIGH);
-    qint32 qrCodeSize = qrCode.getSize();
-    QImage qrCodeImage(qrCodeSize, qrCodeSize, QImage::Format_RGB32);
-    QRgb colorBlack = qRgb(0, 0, 0);
-    QRgb colorWhite = qRgb(255, 255, 255);
-    for (int y = 0; y < qrCodeSize; ++y) {
-        for (int x = 0; x < qrCodeSize; ++x) {
-            qrCodeImage.setPixel(x, y, qrCode.getModule(x, y) ? colorBlack : colorWhite);
-        }
+    QStringList pageArgs = page ? page->property("guid_tab_pending_args").toStringList() : QStringList();
+    if (pageArgs.isEmpty())
+        return;
+    page->setProperty("guid_tab_pending_args", QVariant());
+    page->setProperty("guid_tab_default_values", QVariant());
+    
+    m_formsPage = page;
+    showForms(pageArgs);
+    m_formsPage = NULL;
+    indexWidgets(page);
+}
+
+// Reads the values a page never shown would print by building its fields once in a throwaway
+// widget. The page itself is still built when it's first shown.
+void Guid::readTabPageValues(QWidget *page)
+{
+    QStringList pageArgs = page ? page->property("guid_tab_pending_args").toStringList() : QStringList();
+    if (pageArgs.isEmpty() || page->property("guid_tab_default_values").isValid())
+        return;
+    
+    QWidget shadowPage;
+    shadowPage.setLayout(new QFormLayout());
+    m_formsPage = &shadowPage;
+    m_formsValuesOnly = true;
+    showForms(pageArgs);
+    m_formsValuesOnly = false;
+    m_formsPage = NULL;
+    
+    QString dateFormat = m_dialog->property("guid_date_format").toString();
+    QString separator = m_dialog->property("guid_separator").toString();
+    QString listRowSeparator = m_dialog->property("guid_list_row_separator").toString();
+    QStringList pageValues;
+    foreach (QWidget *field, shadowPage.findChildren<QWidget*>(QString(), Qt::FindDirectChildrenOnly)) {
+        if (qstrcmp(field->metaObject()->className(), "QLabel") == 0)
+            continue;
+        ValueText fieldValue;
+        if (getFormsWidgetValue(field, dateFormat, separator, listRowSeparator, fieldValue))
+            pageValues << fieldValue.text();
+    }
+    page->setProperty("guid_tab_default_values", pageValues);
+}
+
+void Guid::createQRCode(QLabel *label, QString text, bool async)
+{
+    const qrcodegen::QrCode::Ecc ecc = qrcodegen::QrCode::Ecc::HIGH;
+    const int side = 256;
+    const QString key = qrCodeKey(text, ecc, side);
+    
+    if (QImage *cached = gs_qrCodeImages.object(key)) {
+        label->setPixmap(QPixmap::fromImage(*cached, Qt::MonoOnly));
+        return;
     }
-    label->setPixmap(QPixmap::fromImage(qrCodeImage.scaled(256, 256, Qt::KeepAspectRatio, Qt::FastTransformation), Qt::MonoOnly));
+    
+    if (!async) {
+        QImage *image = new QImage(qrCodeImage(text, ecc, side));
+        label->setPixmap(QPixmap::fromImage(*image, Qt::MonoOnly));
+        gs_qrCodeImages.insert(key, image);
+        return;
+    }
+    
+    // The label keeps its place in the form while the code is encoded on a worker thread.
+    label->setMinimumSize(side, side);
+    QSharedPointer<QImage> image(new QImage);
+    QThread *encoder = QThread::create([=]() {
+        *image = qrCodeImage(text, ecc, side);
+    });
+    connect(encoder, &QThread::finished, label, [=]() {
+        label->setPixmap(QPixmap::fromImage(*image, Qt::MonoOnly));
+        gs_qrCodeImages.insert(key, new QImage(*image));
+    });
+    connect(encoder, &QThread::finished, encoder, &QObject::deleteLater);
+    encoder->start();
 }
 
 bool Guid::error(const QString message)
@@ -3384,6 +6215,58 @@ bool Guid::error(const QString message)
     return true;
 }
 
+void Guid::finishRequest(int exitCode)
+{
+    #ifdef Q_OS_UNIX
+        if (m_sysTray)
+            m_sysTray->hide();
+        if (m_dialog)
+            m_dialog->hide();
+    
+        fflush(stdout);
+        fflush(stderr);
+        const qint32 code = exitCode;
+        socketWrite(m_clientFd, (const char*)&code, sizeof(code));
+        ::close(m_clientFd);
+        for (int i = 0; i < 3; ++i)
+            ::dup2(m_savedFds[i], i);
+        clearerr(stdin);
+        gs_parentPid = 0;
+        if (gs_requestTrace) {
+            TraceSpan::finish();
+            gs_requestTrace = false;
+        }
+        setEnvironment(gs_serverEnvironment);
+        if (::chdir(gs_serverDirectory.constData()) < 0)
+            qWarning().noquote() << "cannot enter" << gs_serverDirectory;
+        QTextCodec::setCodecForLocale(gs_serverCodec); // set to UTF-8 by text and file readers
+    
+        // Everything the dialog left behind goes, the next client starts from scratch.
+        if (m_sysTray)
+            m_sysTray->deleteLater();
+        if (m_dialog)
+            m_dialog->deleteLater();
+        if (gs_stdin) {
+            gs_stdin->disconnect(); // don't finish a progress dialog that is already gone
+            gs_stdin->close();
+            delete gs_stdin;
+            gs_stdin = NULL;
+        }
+        delete m_stdinTimer;
+        delete m_requestScope;
+        gs_fileWidgets.clear();
+        gs_markerFiles.clear();
+        gs_typeWidgets.clear();
+        gs_widgetFiles.clear();
+        IconCache::instance()->cancel();
+        Notifier::forget();
+        resetState();
+        m_serverNotifier->setEnabled(true);
+    #else
+        Q_UNUSED(exitCode);
+    #endif
+}
+
 QString Guid::labelText(const QString &s) const
 {
     // zenity uses pango markup, https://developer.gnome.org/pygtk/stable/pango-markup-language.html
@@ -3418,6 +6301,50 @@ QString Guid::labelText(const QString &s) const
     return s;
 }
 
+void Guid::listenToClients(const QString &socketPath)
+{
+    QOUT_ERR
+    #ifdef Q_OS_UNIX
+        sockaddr_un address;
+        if (!socketAddress(QFile::encodeName(socketPath), address)) {
+            error("--server must be followed by the path of the socket (or GUID_SERVER must be set)");
+            return;
+        }
+        // Take over the socket of a server that is gone, but don't steal it from a running one.
+        struct stat info;
+        if (::stat(address.sun_path, &info) == 0 && S_ISSOCK(info.st_mode) &&
+            !isServerListening(QFile::encodeName(socketPath)))
+            ::unlink(address.sun_path);
+    
+        m_serverFd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (m_serverFd < 0 || ::bind(m_serverFd, (sockaddr*)&address, sizeof(address)) < 0 || ::listen(m_serverFd, 16) < 0) {
+            qOutErr << m_prefixErr + "cannot listen on " + socketPath + ": " + QString::fromLocal8Bit(strerror(errno)) << Qt::endl;
+            if (m_serverFd > -1)
+                ::close(m_serverFd);
+            m_serverFd = -1;
+            QMetaObject::invokeMethod(this, "exitGuid", Qt::QueuedConnection, Q_ARG(int, 2));
+            return;
+        }
+        for (int i = 0; i < 3; ++i)
+            m_savedFds[i] = ::dup(i);
+        char cwd[PATH_MAX];
+        gs_serverDirectory = ::getcwd(cwd, sizeof(cwd)) ? cwd : "/";
+        gs_serverEnvironment = environmentList();
+        gs_serverCodec = QTextCodec::codecForLocale();
+        // The output goes to the stdout of the client, which may be a closed pipe by now
+        // (`| head`, Ctrl-C): that write must fail, not kill the server.
+        ::signal(SIGPIPE, SIG_IGN);
+    
+        setQuitOnLastWindowClosed(false);
+        m_serverNotifier = new QSocketNotifier(m_serverFd, QSocketNotifier::Read, this);
+        connect (m_serverNotifier, SIGNAL(activated(int)), SLOT(acceptClient()));
+    #else
+        Q_UNUSED(socketPath);
+        qOutErr << m_prefixErr + "--server is only supported on Unix" << Qt::endl;
+        QMetaObject::invokeMethod(this, "exitGuid", Qt::QueuedConnection, Q_ARG(int, 2));
+    #endif
+}
+
 void Guid::listenToStdIn()
 {
     if (gs_stdin)
@@ -3426,6 +6353,9 @@ void Guid::listenToStdIn()
     if (gs_stdin->open(stdin, QIODevice::ReadOnly)) {
         QSocketNotifier *snr = new QSocketNotifier(gs_stdin->handle(), QSocketNotifier::Read, gs_stdin);
         connect (snr, SIGNAL(activated(int)), SLOT(readStdIn()));
+        m_stdinTimer = new QTimer(this);
+        m_stdinTimer->setSingleShot(true);
+        connect (m_stdinTimer, SIGNAL(timeout()), SLOT(processStdIn()));
     } else {
         delete gs_stdin;
         gs_stdin = NULL;
@@ -3434,17 +6364,15 @@ void Guid::listenToStdIn()
 
 void Guid::notify(const QString message, bool noClose)
 {
-    if (QDBusConnection::sessionBus().interface()->isServiceRegistered("org.freedesktop.Notifications")) {
-        QDBusInterface notifications("org.freedesktop.Notifications", "/org/freedesktop/Notifications", "org.freedesktop.Notifications");
+    if (Notifier::isAvailable()) {
         const QString summary = (message.length() < 32) ? message : message.left(25) + "...";
         QVariantMap hintMap;
         QStringList hintList = m_notificationHints.split(':');
         for (int i = 0; i < hintList.count() - 1; i+=2)
             hintMap.insert(hintList.at(i), hintList.at(i+1));
-        QDBusMessage msg = notifications.call("Notify", "Guid", m_notificationId, "dialog-information", summary, message,
-                                              QStringList() /*actions*/, hintMap, m_timeout);
-        if (msg.arguments().count())
-            m_notificationId = msg.arguments().at(0).toUInt();
+        if (!m_notifier)
+            m_notifier = new Notifier(m_requestScope);
+        m_notifier->notify(summary, message, hintMap, m_timeout);
         return;
     }
 
@@ -3467,28 +6395,42 @@ void Guid::notify(const QString message, bool noClose)
     dlg->move(QGuiApplication::screens().at(0)->availableGeometry().topRight() - QPoint(dlg->width() + 20, -20));
 }
 
-QString Guid::printForms()
+// The values are also returned, joined, when the caller needs them.
+QString Guid::printForms(bool joined)
 {
-    QOUT
     QFileDialog *dialog = static_cast<QFileDialog*>(m_dialog);
     QList<QFormLayout*> layouts = dialog->findChildren<QFormLayout*>();
     // We skip the first layout used for the top menu.
     QFormLayout *fl = layouts.at(1);
     QStringList resultList;
-    ValuePair resultPair;
     QString dateFormat = dialog->property("guid_date_format").toString();
     QString separator = dialog->property("guid_separator").toString();
     QString listRowSeparator = dialog->property("guid_list_row_separator").toString();
+    OutputWriter out(m_prefixOk, separator, m_outputFormat == NulTerminated);
+    // Pages never shown print the default values of their fields.
+    foreach (QTabWidget *tabBar, dialogWidgets<QTabWidget>()) {
+        for (int i = 0; i < tabBar->count(); ++i)
+            readTabPageValues(tabBar->widget(i));
+    }
+    // Unless the values are wanted joined as well, they go out as they are read.
+    ValueText streamed(&out);
     for (int i = 0; i < fl->count(); ++i) {
         if (QLayoutItem *li = fl->itemAt(i, QFormLayout::FieldRole)) {
-            resultPair = getFormsWidgetValue(li->widget(), dateFormat, separator, listRowSeparator);
-            if (resultPair.first)
-                resultList << resultPair.second;
+            if (joined) {
+                ValueText fieldValue;
+                if (getFormsWidgetValue(li->widget(), dateFormat, separator, listRowSeparator, fieldValue)) {
+                    out.add(fieldValue.text());
+                    resultList << fieldValue.text();
+                }
+            } else {
+                streamed.setPending(out.nextSeparator());
+                if (getFormsWidgetValue(li->widget(), dateFormat, separator, listRowSeparator, streamed))
+                    out.endValue();
+            }
         }
     }
-    QString result = m_prefixOk + resultList.join(separator);
-    qOut << result << Qt::endl;
-    return result;
+    out.finish();
+    return joined ? m_prefixOk + resultList.join(separator) : QString();
 }
 
 bool Guid::readGeneral(QStringList &args) {
@@ -3515,7 +6457,33 @@ bool Guid::readGeneral(QStringList &args) {
             const int t = NEXT_ARG.toUInt(&ok);
             if (!ok)
                 return !error("--timeout must be followed by a positive number");
-            QTimer::singleShot(t*1000, this, SLOT(quitDialog()));
+            QTimer::singleShot(t*1000, m_requestScope, [this]() { quitDialog(); });
+        } else if (args.at(i) == "--stdin-batch-ms") {
+            bool ok;
+            const int ms = NEXT_ARG.toUInt(&ok);
+            if (!ok)
+                return !error("--stdin-batch-ms must be followed by a positive number");
+            m_stdinBatchMs = ms;
+        } else if (args.at(i) == "--stdin-format") {
+            const QString format = NEXT_ARG;
+            if (format == "lines")
+                m_stdinFormat = Lines;
+            else if (format == "nul")
+                m_stdinFormat = NulDelimited;
+            else if (format == "lenprefix")
+                m_stdinFormat = LengthPrefixed;
+            else
+                return !error("--stdin-format must be followed by lines, nul or lenprefix");
+        } else if (args.at(i) == "--trace") {
+            NEXT_ARG; // tracing is started by main()
+        } else if (args.at(i) == "--output-format") {
+            const QString format = NEXT_ARG;
+            if (format == "text")
+                m_outputFormat = Text;
+            else if (format == "nul")
+                m_outputFormat = NulTerminated;
+            else
+                return !error("--output-format must be followed by text or nul");
         } else if (args.at(i) == "--ok-label") {
             m_ok = NEXT_ARG;
         } else if (args.at(i) == "--cancel-label") {
@@ -3544,47 +6512,212 @@ bool Guid::readGeneral(QStringList &args) {
     return true;
 }
 
-void Guid::setSysTrayAction(QString actionId, bool valueToSet)
-{
-    QSystemTrayIcon *sysTrayIcon = static_cast<QSystemTrayIcon*>(m_sysTray);
-    if (sysTrayIcon) {
-        QList<QAction*> actions = sysTrayIcon->contextMenu()->actions();
-        foreach(QAction *action, actions) {
-            if (action->property("guid_systray_menu_action").toString() == actionId) {
-                action->setEnabled(valueToSet);
-                break;
-            }
+// Server mode reuses the process for the next dialog, so the options of the previous one
+// must not stick. Keep in sync with the constructor.
+void Guid::resetState()
+{
+    m_alwaysOnTop = false;
+    m_cancel = QString();
+    m_caption = QString();
+    m_clientFd = -1;
+    m_closeToSysTray = false;
+    m_dialog = NULL;
+    m_formsPage = NULL;
+    m_formsValuesOnly = false;
+    m_icon = QString();
+    m_modal = false;
+    m_noTaskbar = false;
+    m_notificationHints = QString();
+    m_notifier = NULL;
+    m_ok = QString();
+    m_okCommand = "";
+    m_okCommandToFooter = false;
+    m_okCoprocess = NULL;
+    m_okKeepOpen = false;
+    m_okValuesToFooter = false;
+    m_outputFormat = Text;
+    m_parentWindow = 0;
+    m_prefixErr = "";
+    m_prefixOk = "";
+    m_requestScope = NULL;
+    m_selectableLabel = false;
+    m_size = QSize();
+    m_stdinBatchMs = 16;
+    m_stdinBuffer.clear();
+    m_stdinCells.clear();
+    m_stdinClosed = false;
+    m_stdinFormat = Lines;
+    m_stdinText.clear();
+    m_stdinTimer = NULL;
+    m_sysTray = NULL;
+    m_sysTrayMsg = false;
+    m_timeout = 0;
+    m_type = Invalid;
+    m_zenity = false;
+}
+
+void Guid::setSysTrayAction(QString actionId, bool valueToSet)
+{
+    QSystemTrayIcon *sysTrayIcon = static_cast<QSystemTrayIcon*>(m_sysTray);
+    if (sysTrayIcon) {
+        QList<QAction*> actions = sysTrayIcon->contextMenu()->actions();
+        foreach(QAction *action, actions) {
+            if (action->property("guid_systray_menu_action").toString() == actionId) {
+                action->setEnabled(valueToSet);
+                break;
+            }
+        }
+    }
+}
+
+void Guid::start(QStringList argList)
+{
+    TraceSpan span("Guid::start");
+    const qint64 traceStart = TraceSpan::now();
+    m_requestScope = new QObject(this);
+    m_zenity = argList.at(0).endsWith("zenity");
+    // make canonical list
+    QStringList args;
+    if (argList.at(0).endsWith("-askpass")) {
+        argList.removeFirst();
+        args << "--title" << tr("Enter Password") << "--password" << "--prompt" << argList.join(' ');
+    } else {
+        args = splitOptions(argList, 1);
+    }
+    argList.clear();
+    
+    // The options of a spec file take its place, a spec file can't include another one.
+    for (int i = args.indexOf("--forms-spec"); i > -1; i = args.indexOf("--forms-spec", i)) {
+        TraceSpan specSpan("forms spec");
+        QStringList options;
+        if (i + 1 >= args.count() || !readFormsSpec(args.at(i + 1), options)) {
+            error("--forms-spec must be followed by the path of a readable file");
+            return;
+        }
+        args = args.mid(0, i) + options + args.mid(i + 2);
+        i += options.count();
+    }
+
+    {
+        TraceSpan parseSpan("readGeneral");
+        if (!readGeneral(args))
+            return;
+    }
+
+    TraceSpan showSpan("show dialog");
+    char error = 1;
+    foreach (const QString &arg, args) {
+        if (arg == "--calendar") {
+            m_type = Calendar;
+            error = showCalendar(args);
+        } else if (arg == "--entry") {
+            m_type = Entry;
+            error = showEntry(args);
+        } else if (arg == "--error") {
+            m_type = Error;
+            error = showMessage(args, 'e');
+        } else if (arg == "--info") {
+            m_type = Info;
+            error = showMessage(args, 'i');
+        } else if (arg == "--file-selection") {
+            m_type = FileSelection;
+            error = showFileSelection(args);
+        } else if (arg == "--list") {
+            m_type = List;
+            error = showList(args);
+        } else if (arg == "--notification") {
+            m_type = Notification;
+            error = showNotification(args);
+        } else if (arg == "--progress") {
+            m_type = Progress;
+            error = showProgress(args);
+        } else if (arg == "--question") {
+            m_type = Question;
+            error = showMessage(args, 'q');
+        } else if (arg == "--warning") {
+            m_type = Warning;
+            error = showMessage(args, 'w');
+        } else if (arg == "--scale") {
+            m_type = Scale;
+            error = showScale(args);
+        } else if (arg == "--text-info") {
+            m_type = TextInfo;
+            error = showText(args);
+        } else if (arg == "--color-selection") {
+            m_type = ColorSelection;
+            error = showColorSelection(args);
+        } else if (arg == "--font-selection") {
+            m_type = FontSelection;
+            error = showFontSelection(args);
+        } else if (arg == "--password") {
+            m_type = Password;
+            error = showPassword(args);
+        } else if (arg == "--forms") {
+            m_type = Forms;
+            error = showForms(args);
+        }
+        if (error != 1) {
+            break;
+        }
+    }
+
+    if (error) {
+        QMetaObject::invokeMethod(this, "exitGuid", Qt::QueuedConnection, Q_ARG(int, 2));
+        return;
+    }
+
+    if (m_dialog) {
+        // close on ctrl+return in addition to ctrl+enter
+        QAction *shortAccept = new QAction(m_dialog);
+        m_dialog->addAction(shortAccept);
+        shortAccept->setShortcut(QKeySequence(Qt::CTRL + Qt::Key_Return));
+        connect (shortAccept, SIGNAL(triggered()), m_dialog, SLOT(accept()));
+
+        // workaround for #21 - since QWidget is now merely bitrot, QDialog closes,
+        // but does not reject on the escape key (unlike announced in the specific section of the API)
+        QAction *shortReject = new QAction(m_dialog);
+        m_dialog->addAction(shortReject);
+        shortReject->setShortcut(QKeySequence(Qt::Key_Escape));
+        connect (shortReject, SIGNAL(triggered()), m_dialog, SLOT(reject()));
+        
+        m_dialog->setWindowModality(m_modal ? Qt::ApplicationModal : Qt::NonModal);
+        if (!m_caption.isNull())
+            m_dialog->setWindowTitle(m_caption);
+        if (!m_icon.isNull())
+            m_dialog->setWindowIcon(QIcon(m_icon));
+        QDialogButtonBox *box = m_dialog->findChild<QDialogButtonBox*>();
+        if (box && !m_ok.isNull()) {
+            if (QPushButton *btn = box->button(QDialogButtonBox::Ok))
+                btn->setText(m_ok);
+        }
+        if (box && !m_cancel.isNull()) {
+            if (QPushButton *btn = box->button(QDialogButtonBox::Cancel))
+                btn->setText(m_cancel);
+        }
+        if (m_parentWindow) {
+            #ifdef WS_X11
+                m_dialog->setAttribute(Qt::WA_X11BypassTransientForHint);
+                XSetTransientForHint(QX11Info::display(), m_dialog->winId(), m_parentWindow);
+            #endif
         }
+        FirstFrameTrace::watch(m_dialog, traceStart);
     }
 }
 
-void Guid::updateFooterContent(QGroupBox *footer, QString newEntry)
+void Guid::updateFooterContent(QGroupBox *footer, const QStringList &newEntries)
 {
-    if (!footer || !(m_okCommandToFooter || m_okValuesToFooter))
+    if (!footer || !(m_okCommandToFooter || m_okValuesToFooter) || newEntries.isEmpty())
         return;
     
-    QFormLayout *footerLayout = static_cast<QFormLayout*>(footer->layout());
-    if (!footerLayout)
+    if (!footer->layout())
         return;
     
     int nbEntriesToDisplay = footer->property("guid_footer_nb_entries").toInt();
     int footerHeight = footer->height();
     footer->setVisible(true);
     
-    QLabel *newLabel = new QLabel();
-    newLabel->setText(newEntry);
-    newLabel->setWordWrap(true);
-    newLabel->setTextInteractionFlags(newLabel->textInteractionFlags()|Qt::TextSelectableByMouse);
-    
-    footerLayout->insertRow(0, newLabel);
-    
-    int nbEntries = 0;
-    for (int i = 0; i < footerLayout->count(); ++i) {
-        nbEntries++;
-        if (nbEntries <= nbEntriesToDisplay)
-            continue;
-        footerLayout->removeRow(nbEntries - 1);
-    }
+    // The footer is always created as a FooterBox by showForms().
+    static_cast<FooterBox*>(footer)->addEntries(newEntries, nbEntriesToDisplay);
     
     int newFooterHeight = footer->height();
     if (newFooterHeight > footerHeight) {
@@ -3602,18 +6735,11 @@ void Guid::updateFooterContentFromFile(QGroupBox *footer, QString filePath)
     if (!QFile::exists(filePath))
         return;
     
-    QStringList newEntries;
-    QFile file(filePath);
-    QTextCodec::setCodecForLocale(QTextCodec::codecForName("UTF-8"));
-    if (file.open(QIODevice::ReadOnly)) {
-        newEntries = QString::fromLocal8Bit(file.readAll()).trimmed().replace(QRegExp("[\r\n]+"), "\n").split("\n");
-        file.close();
-    }
-    
-    int nbNewEntries = newEntries.count();
-    for (int i = nbNewEntries - 1; i >= 0; --i) {
-        updateFooterContent(footer, newEntries.at(i));
-    }
+    loadInBackground<QStringList>(footer, [=]() { return readFileLines(filePath, "\n"); },
+                                  [=](const QStringList &newEntries) {
+        // The first line of the file is the newest entry.
+        updateFooterContent(footer, newEntries);
+    });
 }
 
 // End of "private (1 of 2): misc."
@@ -3835,11 +6961,18 @@ char Guid::showFontSelection(const QStringList &args)
     return 0;
 }
 
-char Guid::showForms(const QStringList &args)
+char Guid::showForms(const QStringList &formArgs)
 {
     QOUT_ERR
+    TraceSpan span(m_formsPage ? "showForms (tab page)" : "showForms");
+    span.arg("args", formArgs.count());
     QSettings guidQSsettings("guid");
     
+    // With "--lazy-tabs", fields of hidden tabs are only built when their tab is first shown.
+    QHash<int, QStringList> deferredPages;
+    const QStringList args = (!m_formsPage && formArgs.contains("--lazy-tabs")) ?
+                             deferTabPages(formArgs, deferredPages) : formArgs;
+    
     /**************************************
      * Container: Dialog: QDialog *dlg
      **************************************/
@@ -3849,6 +6982,12 @@ char Guid::showForms(const QStringList &args)
     dlg->setProperty("guid_separator", "|");
     dlg->setProperty("guid_list_row_separator", "~");
     
+    if (m_formsPage) {
+        dlg->setProperty("guid_date_format", m_dialog->property("guid_date_format"));
+        dlg->setProperty("guid_separator", m_dialog->property("guid_separator"));
+        dlg->setProperty("guid_list_row_separator", m_dialog->property("guid_list_row_separator"));
+    }
+    
     Qt::WindowFlags dlgFlags = Qt::WindowCloseButtonHint;
     dlg->setWindowFlags(dlgFlags);
     
@@ -3905,11 +7044,17 @@ char Guid::showForms(const QStringList &args)
     
     // 4. Form layout
     
-    QFormLayout *fl = new QFormLayout();
-    fl->setContentsMargins(wSpacing, wSpacing, wSpacing, wSpacing);
-    fl->setSpacing(wSpacing);
-    
-    tll->addLayout(fl);
+    QFormLayout *fl;
+    if (m_formsPage) {
+        // A deferred tab page is built in a scratch dialog, its fields going straight to the page.
+        fl = static_cast<QFormLayout*>(m_formsPage->layout());
+    } else {
+        fl = new QFormLayout();
+        fl->setContentsMargins(wSpacing, wSpacing, wSpacing, wSpacing);
+        fl->setSpacing(wSpacing);
+        
+        tll->addLayout(fl);
+    }
     
     // 5. Footer
     
@@ -3917,14 +7062,14 @@ char Guid::showForms(const QStringList &args)
     footerContainerLayout->setContentsMargins(wSpacing, 0, wSpacing, wSpacing);
     footerContainerLayout->setSpacing(wSpacing);
     
-    QGroupBox *footer = new QGroupBox(tr("Recent activity"));
+    QGroupBox *footer = new FooterBox(tr("Recent activity"));
     footer->setObjectName("dialogFooter");
     footer->setProperty("guid_footer_nb_entries", 3);
     footer->setProperty("guid_footer_file_path", "");
     footer->setProperty("guid_footer_monitor_file", false);
     footer->setVisible(false);
     
-    QFileSystemWatcher *footerWatcher = new QFileSystemWatcher(dlg);
+    FileWatcher *footerWatcher = new FileWatcher(this, "updateFooter", dlg);
     
     QFormLayout *footerLayout = new QFormLayout();
     footerLayout->setContentsMargins(wSpacing, wSpacing, wSpacing, wSpacing);
@@ -4000,7 +7145,7 @@ char Guid::showForms(const QStringList &args)
     QComboBox *lastCombo = NULL;
     QLabel *lastComboLabel = NULL;
     GList lastComboGList = GList();
-    QFileSystemWatcher *comboWatcher = new QFileSystemWatcher(dlg);
+    FileWatcher *comboWatcher = new FileWatcher(this, "updateCombo", dlg);
     
     // entry
     QLineEdit *lastEntry = NULL;
@@ -4020,7 +7165,7 @@ char Guid::showForms(const QStringList &args)
     QString lastHRuleCss = NULL;
     
     // list
-    QTreeWidget *lastList = NULL;
+    QTreeView *lastList = NULL;
     QLabel *lastListLabel = NULL;
     QWidget *lastListContainer = NULL;
     QFormLayout *lastListLayout = NULL;
@@ -4030,7 +7175,7 @@ char Guid::showForms(const QStringList &args)
     Qt::ItemFlags lastListFlags;
     int lastListHeight = -1;
     QStringList lastListColumns;
-    QFileSystemWatcher *listWatcher = new QFileSystemWatcher(dlg);
+    FileWatcher *listWatcher = new FileWatcher(this, "updateList", dlg);
     
     // menu
     QMenuBar *lastMenu = NULL;
@@ -4065,7 +7210,7 @@ char Guid::showForms(const QStringList &args)
     // text
     QLabel *lastText = NULL;
     QLabel *lastTextLabel = NULL;
-    QFileSystemWatcher *textWatcher = new QFileSystemWatcher(dlg);
+    FileWatcher *textWatcher = new FileWatcher(this, "updateText", dlg);
     
     // text-info || text-browser
     
@@ -4074,7 +7219,7 @@ char Guid::showForms(const QStringList &args)
     QTextBrowser *lastTextBrowser = NULL;
     QLabel *lastTextBrowserLabel = NULL;
     
-    QFileSystemWatcher *textInfoWatcher = new QFileSystemWatcher(dlg);
+    FileWatcher *textInfoWatcher = new FileWatcher(this, "updateTextInfo", dlg);
     
     // vspacer
     QLabel *lastVSpacer = NULL;
@@ -4086,8 +7231,6 @@ char Guid::showForms(const QStringList &args)
      **************************************/
     
     QString next_arg;
-    QStringList next_arg_split;
-    QStringList next_arg_join;
     WidgetSettings ws;
     bool ok;
     
@@ -4152,6 +7295,7 @@ char Guid::showForms(const QStringList &args)
         
         // --tab
         else if (args.at(i) == "--tab") {
+            const int tabArg = i;
             next_arg = NEXT_ARG;
             SET_WIDGET_SETTINGS(next_arg)
             
@@ -4183,6 +7327,9 @@ char Guid::showForms(const QStringList &args)
                 connect(lastTabBar, SIGNAL(currentChanged(int)), this, SLOT(afterTabBarClick(int)), Qt::UniqueConnection);
             }
             
+            if (deferredPages.contains(tabArg))
+                lastTab->setProperty("guid_tab_pending_args", deferredPages.value(tabArg));
+            
             lastWidgetVar = "";
         }
         
@@ -4492,35 +7639,11 @@ char Guid::showForms(const QStringList &args)
             lastText->setProperty("guid_hide", false);
             lastText->setProperty("guid_text_content", "");
             
-            lastText->setProperty("guid_text_monitor_marker_file_1", "");
-            lastText->setProperty("guid_text_monitor_marker_file_2", "");
-            lastText->setProperty("guid_text_monitor_marker_file_3", "");
-            lastText->setProperty("guid_text_monitor_marker_file_4", "");
-            lastText->setProperty("guid_text_monitor_marker_file_5", "");
-            lastText->setProperty("guid_text_monitor_marker_file_6", "");
-            lastText->setProperty("guid_text_monitor_marker_file_7", "");
-            lastText->setProperty("guid_text_monitor_marker_file_8", "");
-            lastText->setProperty("guid_text_monitor_marker_file_9", "");
-            
-            lastText->setProperty("guid_text_monitor_var_name_1", "");
-            lastText->setProperty("guid_text_monitor_var_name_2", "");
-            lastText->setProperty("guid_text_monitor_var_name_3", "");
-            lastText->setProperty("guid_text_monitor_var_name_4", "");
-            lastText->setProperty("guid_text_monitor_var_name_5", "");
-            lastText->setProperty("guid_text_monitor_var_name_6", "");
-            lastText->setProperty("guid_text_monitor_var_name_7", "");
-            lastText->setProperty("guid_text_monitor_var_name_8", "");
-            lastText->setProperty("guid_text_monitor_var_name_9", "");
-            
-            lastText->setProperty("guid_text_def_marker_val_1", "");
-            lastText->setProperty("guid_text_def_marker_val_2", "");
-            lastText->setProperty("guid_text_def_marker_val_3", "");
-            lastText->setProperty("guid_text_def_marker_val_4", "");
-            lastText->setProperty("guid_text_def_marker_val_5", "");
-            lastText->setProperty("guid_text_def_marker_val_6", "");
-            lastText->setProperty("guid_text_def_marker_val_7", "");
-            lastText->setProperty("guid_text_def_marker_val_8", "");
-            lastText->setProperty("guid_text_def_marker_val_9", "");
+            for (int m = 0; m < 9; ++m) {
+                lastText->setProperty(gs_markerFileProps[m], "");
+                lastText->setProperty(gs_markerVarNameProps[m], "");
+                lastText->setProperty(gs_defMarkerValProps[m], "");
+            }
             
             lastText->setProperty("guid_text_markers_set", false);
             
@@ -4540,135 +7663,28 @@ char Guid::showForms(const QStringList &args)
             }
             lastText->setText(lastTextContent);
             
-            if (!ws.monitorMarkerFile1.isEmpty() || !ws.monitorMarkerFile2.isEmpty() || !ws.monitorMarkerFile3.isEmpty() ||
-                !ws.monitorMarkerFile4.isEmpty() || !ws.monitorMarkerFile5.isEmpty() || !ws.monitorMarkerFile6.isEmpty() ||
-                !ws.monitorMarkerFile7.isEmpty() || !ws.monitorMarkerFile8.isEmpty() || !ws.monitorMarkerFile9.isEmpty()) {
+            bool hasMarkerFile = false;
+            for (int m = 0; m < 9; ++m)
+                hasMarkerFile = hasMarkerFile || !ws.monitorMarkerFile[m].isEmpty();
+            
+            if (hasMarkerFile) {
                 lastText->setProperty("guid_text_content", lastTextContent);
+                lastText->setProperty("guid_text_segments", markerSegments(lastTextContent));
                 
-                if (!ws.monitorMarkerFile1.isEmpty()) {
-                    lastText->setProperty("guid_text_monitor_marker_file_1", ws.monitorMarkerFile1);
-                    if (QFile::exists(ws.monitorMarkerFile1)) {
-                        textWatcher->addPath(ws.monitorMarkerFile1);
-                        connect(textWatcher, SIGNAL(fileChanged(QString)), this, SLOT(updateText(QString)), Qt::UniqueConnection);
-                    }
-                    
-                    if (!ws.monitorVarName1.isEmpty())
-                        lastText->setProperty("guid_text_monitor_var_name_1", ws.monitorVarName1);
-                    
-                    if (!ws.defMarkerVal1.isEmpty())
-                        lastText->setProperty("guid_text_def_marker_val_1", ws.defMarkerVal1);
-                }
-                
-                if (!ws.monitorMarkerFile2.isEmpty()) {
-                    lastText->setProperty("guid_text_monitor_marker_file_2", ws.monitorMarkerFile2);
-                    if (QFile::exists(ws.monitorMarkerFile2)) {
-                        textWatcher->addPath(ws.monitorMarkerFile2);
-                        connect(textWatcher, SIGNAL(fileChanged(QString)), this, SLOT(updateText(QString)), Qt::UniqueConnection);
-                    }
-                    
-                    if (!ws.monitorVarName2.isEmpty())
-                        lastText->setProperty("guid_text_monitor_var_name_2", ws.monitorVarName2);
-                    
-                    if (!ws.defMarkerVal2.isEmpty())
-                        lastText->setProperty("guid_text_def_marker_val_2", ws.defMarkerVal2);
-                }
-                
-                if (!ws.monitorMarkerFile3.isEmpty()) {
-                    lastText->setProperty("guid_text_monitor_marker_file_3", ws.monitorMarkerFile3);
-                    if (QFile::exists(ws.monitorMarkerFile3)) {
-                        textWatcher->addPath(ws.monitorMarkerFile3);
-                        connect(textWatcher, SIGNAL(fileChanged(QString)), this, SLOT(updateText(QString)), Qt::UniqueConnection);
-                    }
-                    
-                    if (!ws.monitorVarName3.isEmpty())
-                        lastText->setProperty("guid_text_monitor_var_name_3", ws.monitorVarName3);
-                    
-                    if (!ws.defMarkerVal3.isEmpty())
-                        lastText->setProperty("guid_text_def_marker_val_3", ws.defMarkerVal3);
-                }
-                
-                if (!ws.monitorMarkerFile4.isEmpty()) {
-                    lastText->setProperty("guid_text_monitor_marker_file_4", ws.monitorMarkerFile4);
-                    if (QFile::exists(ws.monitorMarkerFile4)) {
-                        textWatcher->addPath(ws.monitorMarkerFile4);
-                        connect(textWatcher, SIGNAL(fileChanged(QString)), this, SLOT(updateText(QString)), Qt::UniqueConnection);
-                    }
-                    
-                    if (!ws.monitorVarName4.isEmpty())
-                        lastText->setProperty("guid_text_monitor_var_name_4", ws.monitorVarName4);
-                    
-                    if (!ws.defMarkerVal4.isEmpty())
-                        lastText->setProperty("guid_text_def_marker_val_4", ws.defMarkerVal4);
-                }
-                
-                if (!ws.monitorMarkerFile5.isEmpty()) {
-                    lastText->setProperty("guid_text_monitor_marker_file_5", ws.monitorMarkerFile5);
-                    if (QFile::exists(ws.monitorMarkerFile5)) {
-                        textWatcher->addPath(ws.monitorMarkerFile5);
-                        connect(textWatcher, SIGNAL(fileChanged(QString)), this, SLOT(updateText(QString)), Qt::UniqueConnection);
-                    }
-                    
-                    if (!ws.monitorVarName5.isEmpty())
-                        lastText->setProperty("guid_text_monitor_var_name_5", ws.monitorVarName5);
-                    
-                    if (!ws.defMarkerVal5.isEmpty())
-                        lastText->setProperty("guid_text_def_marker_val_5", ws.defMarkerVal5);
-                }
-                
-                if (!ws.monitorMarkerFile6.isEmpty()) {
-                    lastText->setProperty("guid_text_monitor_marker_file_6", ws.monitorMarkerFile6);
-                    if (QFile::exists(ws.monitorMarkerFile6)) {
-                        textWatcher->addPath(ws.monitorMarkerFile6);
-                        connect(textWatcher, SIGNAL(fileChanged(QString)), this, SLOT(updateText(QString)), Qt::UniqueConnection);
-                    }
-                    
-                    if (!ws.monitorVarName6.isEmpty())
-                        lastText->setProperty("guid_text_monitor_var_name_6", ws.monitorVarName6);
-                    
-                    if (!ws.defMarkerVal6.isEmpty())
-                        lastText->setProperty("guid_text_def_marker_val_6", ws.defMarkerVal6);
-                }
-                
-                if (!ws.monitorMarkerFile7.isEmpty()) {
-                    lastText->setProperty("guid_text_monitor_marker_file_7", ws.monitorMarkerFile7);
-                    if (QFile::exists(ws.monitorMarkerFile7)) {
-                        textWatcher->addPath(ws.monitorMarkerFile7);
-                        connect(textWatcher, SIGNAL(fileChanged(QString)), this, SLOT(updateText(QString)), Qt::UniqueConnection);
-                    }
-                    
-                    if (!ws.monitorVarName7.isEmpty())
-                        lastText->setProperty("guid_text_monitor_var_name_7", ws.monitorVarName7);
-                    
-                    if (!ws.defMarkerVal7.isEmpty())
-                        lastText->setProperty("guid_text_def_marker_val_7", ws.defMarkerVal7);
-                }
-                
-                if (!ws.monitorMarkerFile8.isEmpty()) {
-                    lastText->setProperty("guid_text_monitor_marker_file_8", ws.monitorMarkerFile8);
-                    if (QFile::exists(ws.monitorMarkerFile8)) {
-                        textWatcher->addPath(ws.monitorMarkerFile8);
-                        connect(textWatcher, SIGNAL(fileChanged(QString)), this, SLOT(updateText(QString)), Qt::UniqueConnection);
-                    }
-                    
-                    if (!ws.monitorVarName8.isEmpty())
-                        lastText->setProperty("guid_text_monitor_var_name_8", ws.monitorVarName8);
+                for (int m = 0; m < 9; ++m) {
+                    if (ws.monitorMarkerFile[m].isEmpty())
+                        continue;
                     
-                    if (!ws.defMarkerVal8.isEmpty())
-                        lastText->setProperty("guid_text_def_marker_val_8", ws.defMarkerVal8);
-                }
-                
-                if (!ws.monitorMarkerFile9.isEmpty()) {
-                    lastText->setProperty("guid_text_monitor_marker_file_9", ws.monitorMarkerFile9);
-                    if (QFile::exists(ws.monitorMarkerFile9)) {
-                        textWatcher->addPath(ws.monitorMarkerFile9);
-                        connect(textWatcher, SIGNAL(fileChanged(QString)), this, SLOT(updateText(QString)), Qt::UniqueConnection);
+                    lastText->setProperty(gs_markerFileProps[m], ws.monitorMarkerFile[m]);
+                    if (QFile::exists(ws.monitorMarkerFile[m])) {
+                        watchFile(textWatcher, ws.monitorMarkerFile[m], lastText);
                     }
                     
-                    if (!ws.monitorVarName9.isEmpty())
-                        lastText->setProperty("guid_text_monitor_var_name_9", ws.monitorVarName9);
+                    if (!ws.monitorVarName[m].isEmpty())
+                        lastText->setProperty(gs_markerVarNameProps[m], ws.monitorVarName[m]);
                     
-                    if (!ws.defMarkerVal9.isEmpty())
-                        lastText->setProperty("guid_text_def_marker_val_9", ws.defMarkerVal9);
+                    if (!ws.defMarkerVal[m].isEmpty())
+                        lastText->setProperty(gs_defMarkerValProps[m], ws.defMarkerVal[m]);
                 }
                 
                 setText(lastText);
@@ -4739,6 +7755,7 @@ char Guid::showForms(const QStringList &args)
             lastTextInfo->setProperty("guid_text_read_only", true);
             lastTextInfo->setProperty("guid_text_format", "guess");
             lastTextInfo->setProperty("guid_text_curl_path", "");
+            lastTextInfo->setProperty("guid_text_url_refresh", 0);
             lastTextInfo->setProperty("guid_text_filename", "");
             lastTextInfo->setProperty("guid_text_monitor_file", false);
             lastTextInfo->setProperty("guid_text_is_url", false);
@@ -4765,6 +7782,7 @@ char Guid::showForms(const QStringList &args)
             lastTextBrowser->setProperty("guid_text_read_only", true);
             lastTextBrowser->setProperty("guid_text_format", "html");
             lastTextBrowser->setProperty("guid_text_curl_path", "");
+            lastTextBrowser->setProperty("guid_text_url_refresh", 0);
             lastTextBrowser->setProperty("guid_text_filename", "");
             lastTextBrowser->setProperty("guid_text_monitor_file", false); // Not supported yet
             lastTextBrowser->setProperty("guid_text_is_url", false);
@@ -4795,7 +7813,7 @@ char Guid::showForms(const QStringList &args)
             lastCombo->addItems(lastComboGList.val);
         }
         
-        // QTreeWidget: --add-list
+        // QTreeView: --add-list
         else if (args.at(i) == "--add-list") {
             SWITCH_FORM_WIDGET("list")
             next_arg = NEXT_ARG;
@@ -4803,7 +7821,9 @@ char Guid::showForms(const QStringList &args)
             
             buildFormsList(&lastList, lastListGList, lastListColumns, lastListHeader, lastListFlags, lastListHeight);
             
-            lastList = new QTreeWidget(dlg);
+            lastList = new QTreeView(dlg);
+            lastList->setModel(new ListModel(1, lastList));
+            setUniformRowHeights(lastList, listModel(lastList));
             lastWidget = lastList;
             lastListLabel = new QLabel(next_arg);
             
@@ -4825,6 +7845,8 @@ char Guid::showForms(const QStringList &args)
             lastList->setProperty("guid_list_print_column", "1");
             lastList->setProperty("guid_list_read_only_column", -1);
             lastList->setProperty("guid_list_exclude_from_output", false);
+            lastList->setProperty("guid_list_column_types", QStringList());
+            lastList->setProperty("guid_list_print_order", "original");
             lastList->setSizeAdjustPolicy(QAbstractScrollArea::AdjustToContents);
             lastList->header()->setStretchLastSection(true);
             
@@ -4863,7 +7885,8 @@ char Guid::showForms(const QStringList &args)
             if (ws.addLabel.isEmpty())
                 ws.hideLabel = true;
             
-            createQRCode(lastQRCodeContainer, next_arg);
+            if (!m_formsValuesOnly)
+                createQRCode(lastQRCodeContainer, next_arg, ws.async);
             
             ADD_WIDGET_TO_FORM(lastQRCodeLabel, lastQRCodeContainer)
         }
@@ -5247,8 +8270,7 @@ char Guid::showForms(const QStringList &args)
                 lastCombo->setProperty("guid_monitor_file", lastComboGList.monitorFile);
                 
                 if (QFile::exists(lastComboGList.filePath)) {
-                    comboWatcher->addPath(lastComboGList.filePath);
-                    connect(comboWatcher, SIGNAL(fileChanged(QString)), this, SLOT(updateCombo(QString)), Qt::UniqueConnection);
+                    watchFile(comboWatcher, lastComboGList.filePath, lastCombo);
                 }
                 
                 lastCombo->addItems(lastComboGList.val);
@@ -5317,6 +8339,15 @@ char Guid::showForms(const QStringList &args)
                 WARN_UNKNOWN_ARG("--add-list");
         }
         
+        // --column-types
+        else if (args.at(i) == "--column-types") {
+            next_arg = NEXT_ARG;
+            if (lastWidgetId == "list")
+                lastList->setProperty("guid_list_column_types", next_arg.split('|'));
+            else
+                WARN_UNKNOWN_ARG("--add-list");
+        }
+        
         // --print-column
         else if (args.at(i) == "--print-column") {
             next_arg = NEXT_ARG;
@@ -5347,8 +8378,7 @@ char Guid::showForms(const QStringList &args)
                 lastList->setProperty("guid_monitor_file", lastListGList.monitorFile);
                 
                 if (QFile::exists(lastListGList.filePath)) {
-                    listWatcher->addPath(lastListGList.filePath);
-                    connect(listWatcher, SIGNAL(fileChanged(QString)), this, SLOT(updateList(QString)), Qt::UniqueConnection);
+                    watchFile(listWatcher, lastListGList.filePath, lastList);
                 }
             } else {
                 WARN_UNKNOWN_ARG("--add-list");
@@ -5364,6 +8394,15 @@ char Guid::showForms(const QStringList &args)
                 WARN_UNKNOWN_ARG("--add-list");
         }
         
+        // --print-order
+        else if (args.at(i) == "--print-order") {
+            next_arg = NEXT_ARG;
+            if (lastWidgetId == "list")
+                lastList->setProperty("guid_list_print_order", next_arg.toLower());
+            else
+                WARN_UNKNOWN_ARG("--add-list");
+        }
+        
         // --checklist
         else if (args.at(i) == "--checklist") {
             if (lastWidgetId == "list")
@@ -5374,9 +8413,11 @@ char Guid::showForms(const QStringList &args)
         
         // --radiolist
         else if (args.at(i) == "--radiolist") {
-            if (lastWidgetId == "list")
+            if (lastWidgetId == "list") {
                 lastList->setProperty("guid_list_selection_type", "radiolist");
-            else
+                connect(lastList->model(), SIGNAL(dataChanged(QModelIndex, QModelIndex)),
+                        this, SLOT(toggleItems(QModelIndex)), Qt::UniqueConnection);
+            } else
                 WARN_UNKNOWN_ARG("--add-list");
         }
         
@@ -5714,6 +8755,20 @@ char Guid::showForms(const QStringList &args)
             }
         }
         
+        // --url-refresh
+        else if (args.at(i) == "--url-refresh") {
+            next_arg = NEXT_ARG;
+            int urlRefresh = urlRefreshSeconds(next_arg);
+            if (!urlRefresh)
+                qOutErr << m_prefixErr + urlRefreshError << Qt::endl;
+            else if (lastWidgetId == "text-browser")
+                lastTextBrowser->setProperty("guid_text_url_refresh", urlRefresh);
+            else if (lastWidgetId == "text-info")
+                lastTextInfo->setProperty("guid_text_url_refresh", urlRefresh);
+            else
+                WARN_UNKNOWN_ARG("--text-info");
+        }
+        
         // --curl-path
         else if (args.at(i) == "--curl-path") {
             next_arg = NEXT_ARG;
@@ -5741,9 +8796,7 @@ char Guid::showForms(const QStringList &args)
                 if (ws.monitorFile) {
                     lastTextInfo->setProperty("guid_text_monitor_file", true);
                     if (QFile::exists(next_arg)) {
-                        textInfoWatcher->addPath(next_arg);
-                        connect(textInfoWatcher, SIGNAL(fileChanged(QString)),
-                                this, SLOT(updateTextInfo(QString)), Qt::UniqueConnection);
+                        watchFile(textInfoWatcher, next_arg, lastTextInfo);
                     }
                 }
             } else if (lastWidgetId == "file-sel") {
@@ -5761,122 +8814,160 @@ char Guid::showForms(const QStringList &args)
          * DIALOG SETTINGS
          ********************************************************************************/
         
-        // --win-min-button
-        else if (args.at(i) == "--win-min-button") {
-            dlgFlags = dlg->windowFlags();
-            dlgFlags |= Qt::WindowMinimizeButtonHint;
-            dlg->setWindowFlags(dlgFlags);
-        }
-        
-        // --win-max-button
-        else if (args.at(i) == "--win-max-button") {
-            dlgFlags = dlg->windowFlags();
-            dlgFlags |= Qt::WindowMaximizeButtonHint;
-            dlg->setWindowFlags(dlgFlags);
-        }
-        
-        // --action-after-ok-click
-        else if (args.at(i) == "--action-after-ok-click") {
-            next_arg = NEXT_ARG;
-            SET_WIDGET_SETTINGS(next_arg)
+        // Options of formsDialogOptions() apply to the whole dialog (and are kept out of deferred
+        // tab pages), so only those are parsed here.
+        else if (formsDialogOptions().contains(args.at(i))) {
+            // --win-min-button
+            if (args.at(i) == "--win-min-button") {
+                dlgFlags = dlg->windowFlags();
+                dlgFlags |= Qt::WindowMinimizeButtonHint;
+                dlg->setWindowFlags(dlgFlags);
+            }
+            
+            // --win-max-button
+            else if (args.at(i) == "--win-max-button") {
+                dlgFlags = dlg->windowFlags();
+                dlgFlags |= Qt::WindowMaximizeButtonHint;
+                dlg->setWindowFlags(dlgFlags);
+            }
+            
+            // --action-after-ok-click
+            else if (args.at(i) == "--action-after-ok-click") {
+                next_arg = NEXT_ARG;
+                SET_WIDGET_SETTINGS(next_arg)
             
-            m_okCommand = ws.command;
-            m_okCommandToFooter = ws.commandToFooter;
-            m_okKeepOpen = ws.keepOpen;
-            m_okValuesToFooter = ws.valuesToFooter;
+                m_okCommand = ws.command;
+                m_okCommandToFooter = ws.commandToFooter;
+                m_okKeepOpen = ws.keepOpen;
+                m_okValuesToFooter = ws.valuesToFooter;
             
-            if (m_okCommand.isEmpty())
-                m_okCommandToFooter = false;
-            else if (!m_okCommand.contains(QRegExp("\bGUID_VALUES(_BASE64)?\b")))
-                m_okCommand += "<>GUID_VALUES";
+                if (m_okCommand.isEmpty())
+                    m_okCommandToFooter = false;
+                else if (!m_okCommand.contains(QRegExp("\bGUID_VALUES(_BASE64)?\b")))
+                    m_okCommand += "<>GUID_VALUES";
             
-            if (m_okCommandToFooter)
-                m_okValuesToFooter = false;
+                if (m_okCommandToFooter)
+                    m_okValuesToFooter = false;
+            
+                if (!m_okKeepOpen) {
+                    m_okCommandToFooter = false;
+                    m_okValuesToFooter = false;
+                }
             
-            if (!m_okKeepOpen) {
-                m_okCommandToFooter = false;
-                m_okValuesToFooter = false;
+                delete m_okCoprocess;
+                m_okCoprocess = NULL;
             }
-        }
-        
-        // --no-cancel
-        else if (args.at(i) == "--no-cancel") {
-            noCancelButton = true;
-        }
-        
-        // --close-to-systray
-        else if (args.at(i) == "--close-to-systray") {
-            m_closeToSysTray = true;
-        }
-        
-        // --systray-icon
-        else if (args.at(i) == "--systray-icon") {
-            next_arg = NEXT_ARG;
-            sysTrayIconPath = next_arg;
-        }
-        
-        // --footer-name
-        else if (args.at(i) == "--footer-name") {
-            next_arg = NEXT_ARG;
-            footer->setTitle(next_arg);
-        }
-        
-        // --footer-entries
-        else if (args.at(i) == "--footer-entries") {
-            next_arg = NEXT_ARG;
-            int nbFooterEntries = next_arg.toInt(&ok);
-            if (ok && nbFooterEntries > 0)
-                footer->setProperty("guid_footer_nb_entries", nbFooterEntries);
-        }
-        
-        // --footer-from-file
-        else if (args.at(i) == "--footer-from-file") {
-            next_arg = NEXT_ARG;
-            SET_WIDGET_SETTINGS(next_arg)
             
-            if (QFile::exists(next_arg)) {
-                footer->setProperty("guid_footer_file_path", next_arg);
-                updateFooterContentFromFile(footer, next_arg);
-                
-                if (ws.monitorFile) {
-                    footer->setProperty("guid_footer_monitor_file", true);
-                    footerWatcher->addPath(next_arg);
-                    connect(footerWatcher, SIGNAL(fileChanged(QString)), this, SLOT(updateFooter(QString)), Qt::UniqueConnection);
+            // --ok-coprocess
+            else if (args.at(i) == "--ok-coprocess") {
+                next_arg = NEXT_ARG;
+                SET_WIDGET_SETTINGS(next_arg)
+            
+                delete m_okCoprocess;
+                m_okCoprocess = NULL;
+            
+                if (!next_arg.isEmpty()) {
+                    StdinFormat coprocessFormat = LengthPrefixed;
+                    if (ws.format == "lines")
+                        coprocessFormat = Lines;
+                    else if (ws.format == "nul")
+                        coprocessFormat = NulDelimited;
+            
+                    m_okCoprocess = new Coprocess(next_arg, coprocessFormat, ws.queue > 0 ? ws.queue : 8, m_prefixErr, dlg);
+                    m_okCommand = next_arg;
+                    m_okCommandToFooter = ws.commandToFooter;
+                    m_okKeepOpen = true;
+                    if (m_okCommandToFooter) {
+                        m_okValuesToFooter = false;
+                        m_okCoprocess->setReplyHandler([=](const QString &reply) {
+                            updateFooterContent(footer, QStringList(reply.trimmed()));
+                        });
+                    }
                 }
             }
-        }
-        
-        // --forms-date-format
-        else if (args.at(i) == "--forms-date-format") {
-            next_arg = NEXT_ARG;
-            dlg->setProperty("guid_date_format", next_arg);
-        }
-        
-        // --forms-align
-        else if (args.at(i) == "--forms-align") {
-            next_arg = NEXT_ARG;
-            QString alignment = next_arg;
-            if (alignment == "left") {
-                fl->setLabelAlignment(Qt::AlignLeft);
-            } else if (alignment == "center") {
-                fl->setLabelAlignment(Qt::AlignCenter);
-            } else if (alignment == "right") {
-                fl->setLabelAlignment(Qt::AlignRight);
-            } else {
-                qOutErr << m_prefixErr + "argument --forms-align: unknown value" << args.at(i) << Qt::endl;
+            
+            // --no-cancel
+            else if (args.at(i) == "--no-cancel") {
+                noCancelButton = true;
+            }
+            
+            // --lazy-tabs (handled before parsing)
+            else if (args.at(i) == "--lazy-tabs") {
+            }
+            
+            // --close-to-systray
+            else if (args.at(i) == "--close-to-systray") {
+                m_closeToSysTray = true;
+            }
+            
+            // --systray-icon
+            else if (args.at(i) == "--systray-icon") {
+                next_arg = NEXT_ARG;
+                sysTrayIconPath = next_arg;
+            }
+            
+            // --footer-name
+            else if (args.at(i) == "--footer-name") {
+                next_arg = NEXT_ARG;
+                footer->setTitle(next_arg);
+            }
+            
+            // --footer-entries
+            else if (args.at(i) == "--footer-entries") {
+                next_arg = NEXT_ARG;
+                int nbFooterEntries = next_arg.toInt(&ok);
+                if (ok && nbFooterEntries > 0)
+                    footer->setProperty("guid_footer_nb_entries", nbFooterEntries);
+            }
+            
+            // --footer-from-file
+            else if (args.at(i) == "--footer-from-file") {
+                next_arg = NEXT_ARG;
+                SET_WIDGET_SETTINGS(next_arg)
+            
+                if (QFile::exists(next_arg)) {
+                    footer->setProperty("guid_footer_file_path", next_arg);
+                    updateFooterContentFromFile(footer, next_arg);
+            
+                    if (ws.monitorFile) {
+                        footer->setProperty("guid_footer_monitor_file", true);
+                        footerWatcher->watch(next_arg);
+                    }
+                }
+            }
+            
+            // --forms-date-format
+            else if (args.at(i) == "--forms-date-format") {
+                next_arg = NEXT_ARG;
+                dlg->setProperty("guid_date_format", next_arg);
+            }
+            
+            // --forms-align
+            else if (args.at(i) == "--forms-align") {
+                next_arg = NEXT_ARG;
+                QString alignment = next_arg;
+                if (alignment == "left") {
+                    fl->setLabelAlignment(Qt::AlignLeft);
+                } else if (alignment == "center") {
+                    fl->setLabelAlignment(Qt::AlignCenter);
+                } else if (alignment == "right") {
+                    fl->setLabelAlignment(Qt::AlignRight);
+                } else {
+                    qOutErr << m_prefixErr + "argument --forms-align: unknown value" << args.at(i) << Qt::endl;
+                }
+            }
+            
+            // --separator
+            else if (args.at(i) == "--separator") {
+                next_arg = NEXT_ARG;
+                dlg->setProperty("guid_separator", next_arg);
+            }
+            
+            // --list-row-separator
+            else if (args.at(i) == "--list-row-separator") {
+                next_arg = NEXT_ARG;
+                dlg->setProperty("guid_list_row_separator", next_arg);
             }
-        }
-        
-        // --separator
-        else if (args.at(i) == "--separator") {
-            next_arg = NEXT_ARG;
-            dlg->setProperty("guid_separator", next_arg);
-        }
-        
-        // --list-row-separator
-        else if (args.at(i) == "--list-row-separator") {
-            next_arg = NEXT_ARG;
-            dlg->setProperty("guid_list_row_separator", next_arg);
         }
         
         // --comment
@@ -5899,6 +8990,24 @@ char Guid::showForms(const QStringList &args)
         setTabBar(lastTabBar, fl, lastTabBarLabel, lastTabName, lastTabIndex);
     buildFormsList(&lastList, lastListGList, lastListColumns, lastListHeader, lastListFlags, lastListHeight);
     
+    if (m_formsPage) {
+        for (int row = 0; row < fl->rowCount(); ++row) {
+            QLayoutItem *li = fl->itemAt(row, QFormLayout::FieldRole);
+            if (!li)
+                li = fl->itemAt(row, QFormLayout::SpanningRole);
+            if (li && li->widget())
+                fl->setAlignment(li->widget(), Qt::AlignTop);
+        }
+        // Watchers outlive the scratch dialog, unless the page is only built for its values.
+        if (!m_formsValuesOnly) {
+            foreach (QFileSystemWatcher *watcher, dlg->findChildren<QFileSystemWatcher*>(QString(), Qt::FindDirectChildrenOnly))
+                watcher->setParent(m_dialog);
+        }
+        delete lastTabBar;
+        delete dlg;
+        return 0;
+    }
+    
     if (formLabelInBold) {
         QFont mainLabelFont = formLabel->font();
         mainLabelFont.setBold(true);
@@ -5961,6 +9070,9 @@ char Guid::showForms(const QStringList &args)
     
     SHOW_DIALOG
     
+    foreach (QTabWidget *tabBar, dialogWidgets<QTabWidget>())
+        buildTabPage(tabBar->currentWidget());
+    
     return 0;
 }
 
@@ -5972,25 +9084,30 @@ char Guid::showList(const QStringList &args)
     QLabel *lbl;
     tll->addWidget(lbl = new QLabel(dlg));
 
-    QTreeWidget *tw;
-    tll->addWidget(tw = new QTreeWidget(dlg));
+    QTreeView *tw;
+    tll->addWidget(tw = new QTreeView(dlg));
+    ListModel *model = new ListModel(1, tw);
+    tw->setModel(model);
     tw->setSelectionBehavior(QAbstractItemView::SelectRows);
     tw->setSelectionMode(QAbstractItemView::SingleSelection);
     tw->setRootIsDecorated(false);
+    setUniformRowHeights(tw, model);
     tw->setAllColumnsShowFocus(true);
     tw->setSizeAdjustPolicy(QAbstractScrollArea::AdjustToContents);
     tw->header()->setStretchLastSection(true);
     tw->setProperty("guid_list_print_column", "1");
     tw->setProperty("guid_list_add_value", "");
     
-    bool editable(false), exclusive(false), checkable(false), icons(false), ok, needFilter(true);
+    bool editable(false), exclusive(false), icons(false), ok, searchAllColumns(false);
+    QLineEdit *filter = NULL;
     QString selectionType;
     int heightToSet = -1;
     QStringList columns;
+    QStringList columnTypes;
     GList list = GList();
     QList<int> hiddenCols;
     dlg->setProperty("guid_separator", "|");
-    QFileSystemWatcher * listWatcher = new QFileSystemWatcher(dlg);
+    FileWatcher *listWatcher = new FileWatcher(this, "updateList", dlg);
     
     for (int i = 0; i < args.count(); ++i) {
         if (args.at(i) == "--text")
@@ -6015,6 +9132,13 @@ char Guid::showList(const QStringList &args)
             tw->setFocusPolicy(Qt::NoFocus);
     } else if (args.at(i) == "--column") {
             columns << NEXT_ARG;
+        } else if (args.at(i) == "--column-type") {
+            ListFilter::SortType type;
+            if (columns.isEmpty() || !ListFilter::sortTypeFromName(NEXT_ARG, type))
+                return !error("--column-type must follow a --column and be auto, numeric, natural or text");
+            while (columnTypes.count() < columns.count())
+                columnTypes << QString();
+            columnTypes[columns.count() - 1] = args.at(i);
         } else if (args.at(i) == "--editable")
             editable = true;
         else if (args.at(i) == "--hide-header")
@@ -6031,26 +9155,20 @@ char Guid::showList(const QStringList &args)
             tw->setSelectionMode(QAbstractItemView::NoSelection);
             tw->setAllColumnsShowFocus(false);
             selectionType = "checklist";
-            checkable = true;
         } else if (args.at(i) == "--radiolist") {
             tw->setSelectionMode(QAbstractItemView::NoSelection);
             tw->setAllColumnsShowFocus(false);
             selectionType = "radiolist";
-            checkable = true;
             exclusive = true;
         } else if (args.at(i) == "--imagelist") {
             icons = true;
         } else if (args.at(i) == "--mid-search") {
-            if (needFilter) {
-                needFilter = false;
-                QLineEdit *filter;
+            if (!filter) {
                 tll->addWidget(filter = new QLineEdit(dlg));
                 filter->setPlaceholderText(tr("Filter"));
-                connect (filter, &QLineEdit::textChanged, this, [=](const QString &match){
-                    for (int i = 0; i < tw->topLevelItemCount(); ++i)
-                        tw->topLevelItem(i)->setHidden(!tw->topLevelItem(i)->text(0).contains(match, Qt::CaseInsensitive));
-                });
             }
+        } else if (args.at(i) == "--search-all-columns") {
+            searchAllColumns = true;
         } else if (args.at(i) == "--field-height") {
             heightToSet = NEXT_ARG.toInt(&ok);
             if (!ok)
@@ -6064,11 +9182,12 @@ char Guid::showList(const QStringList &args)
             tw->setProperty("guid_monitor_file", list.monitorFile);
             
             if (QFile::exists(list.filePath)) {
-                listWatcher->addPath(list.filePath);
-                connect(listWatcher, SIGNAL(fileChanged(QString)), this, SLOT(updateList(QString)), Qt::UniqueConnection);
+                watchFile(listWatcher, list.filePath, tw);
             }
         } else if (args.at(i) == "--print-values") {
             tw->setProperty("guid_list_print_values_mode", NEXT_ARG.toLower());
+        } else if (args.at(i) == "--print-order") {
+            tw->setProperty("guid_list_print_order", NEXT_ARG.toLower());
         } else if (args.at(i) != "--list") {
             list.val << args.at(i);
         }
@@ -6077,20 +9196,30 @@ char Guid::showList(const QStringList &args)
         listenToStdIn();
 
     tw->setProperty("guid_list_selection_type", selectionType);
-    tw->setProperty("guid_list_flags", int(editable | checkable << 1 | icons << 2));
+    tw->setProperty("guid_list_column_types", columnTypes);
+    
+    setListSorting(tw, searchAllColumns, filter);
 
     int columnCount = qMax(columns.count(), 1);
-    tw->setColumnCount(columnCount);
-    tw->setHeaderLabels(columns);
+    model->setColumnCount(columnCount);
+    model->setHeaderLabels(columns);
+    setCheckColumn(tw, selectionType);
+    model->setIcons(icons);
+    if (icons) {
+        const int iconSize = tw->style()->pixelMetric(QStyle::PM_SmallIconSize, 0, tw);
+        model->setIconSize(tw->iconSize().isValid() ? tw->iconSize() : QSize(iconSize, iconSize));
+    }
+    if (editable)
+        model->setItemFlags(Qt::ItemIsEditable);
     tw->setStyleSheet(QTREEWIDGET_STYLE);
     foreach (const int &i, hiddenCols)
         tw->setColumnHidden(i, true);
 
     list.val = addColumnToListValues(list.val, list.addValue, columnCount);
-    addItems(tw, list.val, editable, checkable, icons);
+    addItems(tw, list.val);
 
     if (exclusive) {
-        connect (tw, SIGNAL(itemChanged(QTreeWidgetItem*, int)), SLOT(toggleItems(QTreeWidgetItem*, int)));
+        connect (model, SIGNAL(dataChanged(QModelIndex, QModelIndex)), SLOT(toggleItems(QModelIndex)));
     }
     for (int i = 0; i < columns.count(); ++i)
         tw->resizeColumnToContents(i);
@@ -6098,7 +9227,7 @@ char Guid::showList(const QStringList &args)
     if (!selectionType.isEmpty())
         tw->header()->setSectionResizeMode(0, QHeaderView::Fixed);
 
-    if (heightToSet >= 0 && heightToSet < getQTreeWidgetSize(&tw).height())
+    if (heightToSet >= 0 && heightToSet < getListViewSize(tw, heightToSet).height())
         tw->setMaximumHeight(heightToSet);
 
     FINISH_DIALOG(QDialogButtonBox::Ok|QDialogButtonBox::Cancel);
@@ -6148,6 +9277,48 @@ char Guid::showMessage(const QStringList &args, char type)
     return 0;
 }
 
+char Guid::showMultiProgress(const QStringList &args)
+{
+    NEW_DIALOG
+    
+    QLabel *lbl;
+    tll->addWidget(lbl = new QLabel(dlg));
+    lbl->hide();
+    
+    // Rows of channel labels and bars are added by processStdIn() as channels show up.
+    QFormLayout *channels = new QFormLayout;
+    tll->addLayout(channels);
+    dlg->setProperty("guid_multi_progress", true);
+    
+    QDialogButtonBox *btns = new QDialogButtonBox(QDialogButtonBox::Cancel, Qt::Horizontal, dlg);
+    tll->addWidget(btns);
+    connect(btns, SIGNAL(accepted()), dlg, SLOT(accept()));
+    connect(btns, SIGNAL(rejected()), dlg, SLOT(reject()));
+    
+    for (int i = 0; i < args.count(); ++i) {
+        if (args.at(i) == "--text") {
+            lbl->setText(labelText(NEXT_ARG));
+            lbl->show();
+        } else if (args.at(i) == "--auto-close")
+            dlg->setProperty("guid_autoclose", true);
+        else if (args.at(i) == "--auto-kill")
+            dlg->setProperty("guid_autokill_parent", true);
+        else if (args.at(i) == "--no-cancel")
+            btns->hide();
+        else if (args.at(i) == "--time-remaining")
+            dlg->setProperty("guid_eta", true);
+        else if (args.at(i) != "--multi-progress") { WARN_UNKNOWN_ARG("--progress") }
+    }
+    
+    if (!m_cancel.isNull())
+        btns->button(QDialogButtonBox::Cancel)->setText(m_cancel);
+    dlg->setMinimumWidth(400);
+    
+    listenToStdIn();
+    SHOW_DIALOG
+    return 0;
+}
+
 char Guid::showNotification(const QStringList &args)
 {
     QString message;
@@ -6166,8 +9337,12 @@ char Guid::showNotification(const QStringList &args)
     }
     if (!message.isEmpty())
         notify(message, listening);
-    if (!(listening || m_dialog))
-        QMetaObject::invokeMethod(this, "exitGuid", Qt::QueuedConnection);
+    if (!(listening || m_dialog)) {
+        if (m_notifier)
+            m_notifier->finish([this]() { exitGuid(); });
+        else
+            QMetaObject::invokeMethod(this, "exitGuid", Qt::QueuedConnection);
+    }
     return 0;
 }
 
@@ -6207,6 +9382,9 @@ char Guid::showPassword(const QStringList &args)
 
 char Guid::showProgress(const QStringList &args)
 {
+    if (args.contains("--multi-progress"))
+        return showMultiProgress(args);
+    
     QProgressDialog *dlg = new QProgressDialog;
     dlg->setRange(0, 101);
     for (int i = 0; i < args.count(); ++i) {
@@ -6314,13 +9492,20 @@ char Guid::showText(const QStringList &args)
 
     QString filename;
     QString curlPath;
-    bool html(false), plain(false), onlyMarkup(false), url(false);
+    int urlRefresh = 0;
+    bool html(false), plain(false), onlyMarkup(false), paged(false), url(false);
     for (int i = 0; i < args.count(); ++i) {
         if (args.at(i) == "--filename") {
             filename = NEXT_ARG;
+        } else if (args.at(i) == "--paged") {
+            paged = true;
         } else if (args.at(i) == "--url") {
             filename = NEXT_ARG;
             url = true;
+        } else if (args.at(i) == "--url-refresh") {
+            urlRefresh = urlRefreshSeconds(NEXT_ARG);
+            if (!urlRefresh)
+                return !error(urlRefreshError);
         } else if (args.at(i) == "--curl-path") {
             curlPath = NEXT_ARG;
         } else if (args.at(i) == "--editable") {
@@ -6331,6 +9516,12 @@ char Guid::showText(const QStringList &args)
             tll->addWidget(cb = new QCheckBox(NEXT_ARG, dlg));
         } else if (args.at(i) == "--auto-scroll") {
             te->setProperty("guid_autoscroll", true);
+        } else if (args.at(i) == "--max-lines") {
+            bool ok;
+            const int n = NEXT_ARG.toUInt(&ok);
+            if (!ok)
+                return !error("--max-lines must be followed by a positive number");
+            te->document()->setMaximumBlockCount(n);
         } else if (args.at(i) == "--html") {
             html = true;
             te->setProperty("guid_html", true);
@@ -6343,35 +9534,63 @@ char Guid::showText(const QStringList &args)
         }
     }
     
-    if (curlPath.isEmpty())
-        curlPath = "curl";
-    
     if (html) {
         te->setReadOnly(true);
         te->setTextInteractionFlags(onlyMarkup ? Qt::TextSelectableByMouse : Qt::TextBrowserInteraction);
     }
-    if (te->isReadOnly()) {
-        QPalette pal = te->viewport()->palette();
+    
+    // Huge files are mapped and shown page by page instead of being loaded in the QTextBrowser.
+    PagedText *pager(NULL);
+    if (!filename.isNull() && !url && !html && te->isReadOnly() &&
+        (paged || QFileInfo(filename).size() >= PagedText::AutoSize)) {
+        pager = new PagedText(dlg);
+        if (pager->open(filename)) {
+            pager->setFont(te->font());
+            delete tll->replaceWidget(te, pager);
+            delete te;
+            te = NULL;
+            QLineEdit *find = new QLineEdit(dlg);
+            find->setPlaceholderText(tr("Find"));
+            find->setClearButtonEnabled(true);
+            tll->insertWidget(tll->indexOf(pager) + 1, find);
+            connect(find, &QLineEdit::returnPressed, pager, [=]() {
+                pager->find(find->text(), [](bool found) {
+                    if (!found)
+                        QApplication::beep();
+                });
+            });
+            QShortcut *findShortcut = new QShortcut(QKeySequence::Find, dlg);
+            connect(findShortcut, &QShortcut::activated, find, [=]() { find->setFocus(); find->selectAll(); });
+        } else {
+            delete pager;
+            pager = NULL;
+        }
+    }
+    
+    QAbstractScrollArea *view = pager ? static_cast<QAbstractScrollArea*>(pager) : te;
+    if (pager || te->isReadOnly()) {
+        QPalette pal = view->viewport()->palette();
         for (int i = 0; i < 3; ++i) { // Disabled, Active, Inactive, Normal
             QPalette::ColorGroup cg = (QPalette::ColorGroup)i;
             pal.setColor(cg, QPalette::Base, pal.color(cg, QPalette::Window));
             pal.setColor(cg, QPalette::Text, pal.color(cg, QPalette::WindowText));
         }
-        te->viewport()->setPalette(pal);
-        te->viewport()->setAutoFillBackground(false);
-        te->setFrameStyle(QFrame::NoFrame);
+        view->viewport()->setPalette(pal);
+        view->viewport()->setAutoFillBackground(false);
+        view->setFrameStyle(QFrame::NoFrame);
     }
 
     if (filename.isNull()) {
         listenToStdIn();
     } else if (url) {
-        QProcess *curl = new QProcess;
-        connect(curl, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), [=]() {
-            te->setText(QString::fromLocal8Bit(curl->readAllStandardOutput()));
-            delete curl;
-        });
-        curl->start(curlPath, QStringList() << "-L" << "-s" << filename);
-    } else {
+        std::function<void()> fetch = [=]() {
+            fetchUrl(te, filename, curlPath, [=](const QByteArray &content) {
+                te->setText(QString::fromLocal8Bit(content));
+            });
+        };
+        fetch();
+        refreshUrl(te, urlRefresh, fetch);
+    } else if (!pager) {
         QFile file(filename);
         QTextCodec::setCodecForLocale(QTextCodec::codecForName("UTF-8"));
 
@@ -6404,6 +9623,9 @@ char Guid::showText(const QStringList &args)
  * main
  ******************************************************************************/
 
+// The benchmarks build this file with a main() of their own.
+#ifndef GUID_NO_MAIN
+
 int main(int argc, char **argv)
 {
     if (argc < 2) {
@@ -6424,6 +9646,27 @@ int main(int argc, char **argv)
         return 0;
     }
     
+    #ifdef Q_OS_UNIX
+        // Let a running `guid --server` show the dialog, it has Qt already loaded.
+        const QByteArray server = qgetenv("GUID_SERVER");
+        bool isServer = false;
+        for (int i = 1; i < argc; ++i)
+            isServer = isServer || !strcmp(argv[i], "--server") || !strncmp(argv[i], "--server=", 9);
+        if (!server.isEmpty() && !isServer) {
+            const int exitCode = runAsClient(server, argc, argv);
+            if (exitCode > -1)
+                return exitCode;
+        }
+    #endif
+    
+    // Tracing starts before Qt does, so that the startup is part of the trace.
+    QStringList traceArgs;
+    for (int i = 0; i < argc; ++i)
+        traceArgs << QString::fromLocal8Bit(argv[i]);
+    const QString tracePath = traceFilePath(traceArgs);
+    if (!tracePath.isEmpty())
+        TraceSpan::start(tracePath);
+    
     QFont appFont("Sans-serif", 9);
     QApplication::setFont(appFont);
     foreach (QWidget *widget, QApplication::allWidgets()) {
@@ -6431,11 +9674,17 @@ int main(int argc, char **argv)
         widget->update();
     }
     
+    const qint64 traceStart = TraceSpan::now();
     Guid d(argc, argv);
+    TraceSpan::write("Guid::Guid", traceStart);
     
-    return d.exec();
+    const int exitCode = d.exec();
+    TraceSpan::finish();
+    return exitCode;
 }
 
+#endif // GUID_NO_MAIN
+
 // End of "main"
 
 // vim:set et sw=4 ts=4
\ No newline at end of file
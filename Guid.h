@@ -20,15 +20,19 @@
 #ifndef GUID_H
 #define GUID_H
 
+class Coprocess;
+class Notifier;
 class QDialog;
-class QTreeWidgetItem;
+class QSocketNotifier;
+class QTimer;
 
 #include <QApplication>
 #include <QGroupBox>
+#include <QHash>
 #include <QLabel>
 #include <QPair>
 #include <QSystemTrayIcon>
-#include <QTreeWidget>
+#include <QTreeView>
 #include <QWidget>
 
 struct GList {
@@ -39,6 +43,12 @@ struct GList {
     QStringList val;
 };
 
+struct MarkerFile {
+    QString content;
+    bool readable = false;
+    QHash<QString, QString> vars;
+};
+
 struct FormsSettings {
     bool hasLabel = false;
     bool hasTopMenu = false;
@@ -48,46 +58,25 @@ struct FormsSettings {
 struct WidgetSettings {
     QString addLabel = "";
     bool addNewRowButton = false;
+    bool async = false;
     QString backgroundColor = "";
     QString buttonText = "";
     QString color = "";
     QString command = "";
     bool commandToFooter = false;
     int defaultIndex = 0;
-    QString defMarkerVal1 = "";
-    QString defMarkerVal2 = "";
-    QString defMarkerVal3 = "";
-    QString defMarkerVal4 = "";
-    QString defMarkerVal5 = "";
-    QString defMarkerVal6 = "";
-    QString defMarkerVal7 = "";
-    QString defMarkerVal8 = "";
-    QString defMarkerVal9 = "";
+    QString defMarkerVal[9];
     bool disableButtons = false;
     bool excludeFromOutput = false;
     QString foregroundColor = "";
+    QString format = "";
     bool hideLabel = false;
     QString image = "";
     bool keepOpen = false;
     bool monitorFile = false;
-    QString monitorMarkerFile1 = "";
-    QString monitorMarkerFile2 = "";
-    QString monitorMarkerFile3 = "";
-    QString monitorMarkerFile4 = "";
-    QString monitorMarkerFile5 = "";
-    QString monitorMarkerFile6 = "";
-    QString monitorMarkerFile7 = "";
-    QString monitorMarkerFile8 = "";
-    QString monitorMarkerFile9 = "";
-    QString monitorVarName1 = "";
-    QString monitorVarName2 = "";
-    QString monitorVarName3 = "";
-    QString monitorVarName4 = "";
-    QString monitorVarName5 = "";
-    QString monitorVarName6 = "";
-    QString monitorVarName7 = "";
-    QString monitorVarName8 = "";
-    QString monitorVarName9 = "";
+    QString monitorMarkerFile[9];
+    QString monitorVarName[9];
+    int queue = 0;
     QString sep = "";
     bool stop = false;
     bool valuesToFooter = false;
@@ -97,6 +86,7 @@ struct WidgetSettings {
 class Guid : public QApplication
 {
     Q_OBJECT
+    friend class GuidBenchmarks; // benchmarks/ builds and prints dialogs directly
 
 public:
     Guid(int &argc, char **argv);
@@ -104,20 +94,32 @@ public:
         Invalid, Calendar, Entry, Error, Info, FileSelection, List, Notification, Progress,
         Question, Warning, Scale, TextInfo, ColorSelection, FontSelection, Password, Forms
     };
+    enum StdinFormat {
+        Lines, NulDelimited, LengthPrefixed
+    };
+    enum OutputFormat {
+        Text, NulTerminated
+    };
     static void printHelp(const QString &category = QString());
     using  QApplication::notify;
 
 private:
     // Misc.
-    void createQRCode(QLabel *label, QString text);
+    void buildTabPage(QWidget *page);
+    void createQRCode(QLabel *label, QString text, bool async = false);
     bool error(const QString message);
+    void finishRequest(int exitCode);
     QString labelText(const QString &s) const; // m_zenity requires \n and \t interpretation in html.
+    void listenToClients(const QString &socketPath);
     void listenToStdIn();
     void notify(const QString message, bool noClose = false);
-    QString printForms();
+    QString printForms(bool joined = false);
     bool readGeneral(QStringList &args);
+    void readTabPageValues(QWidget *page);
+    void resetState();
     void setSysTrayAction(QString actionId, bool valueToSet);
-    void updateFooterContent(QGroupBox *footer, QString newEntry);
+    void start(QStringList argList);
+    void updateFooterContent(QGroupBox *footer, const QStringList &newEntries);
     void updateFooterContentFromFile(QGroupBox *footer, QString filePath);
     
     // Show dialogs
@@ -129,6 +131,7 @@ private:
     char showForms(const QStringList &args);
     char showList(const QStringList &args);
     char showMessage(const QStringList &args, char type);
+    char showMultiProgress(const QStringList &args);
     char showNotification(const QStringList &args);
     char showPassword(const QStringList &args);
     char showProgress(const QStringList &args);
@@ -136,6 +139,7 @@ private:
     char showText(const QStringList &args);
 
 private slots:
+    void acceptClient();
     void addListRow();
     void afterTabBarClick(int i);
     void afterCloseButtonClick();
@@ -147,11 +151,12 @@ private slots:
     void minimizeDialog();
     void printFormsAfterOKClick();
     void printInteger(int v);
+    void processStdIn();
     void quitDialog();
     void readStdIn();
     void showDialog();
     void showSysTrayMenu(QSystemTrayIcon::ActivationReason reason);
-    void toggleItems(QTreeWidgetItem *item, int column);
+    void toggleItems(const QModelIndex &index);
     void updateCombo(QString filePath);
     void updateFooter(QString filePath);
     void updateList(QString filePath);
@@ -162,24 +167,40 @@ private:
     bool             m_alwaysOnTop;
     QString          m_cancel;
     QString          m_caption;
+    int              m_clientFd;
     bool             m_closeToSysTray;
     QDialog         *m_dialog;
+    QWidget         *m_formsPage;
+    bool             m_formsValuesOnly;
     bool             m_helpMission;
     QString          m_icon;
     bool             m_modal;
     bool             m_noTaskbar;
     QString          m_notificationHints;
-    uint             m_notificationId;
+    Notifier        *m_notifier;
     QString          m_ok;
     QString          m_okCommand;
     bool             m_okCommandToFooter;
+    Coprocess       *m_okCoprocess;
     bool             m_okKeepOpen;
     bool             m_okValuesToFooter;
+    OutputFormat     m_outputFormat;
     int              m_parentWindow;
     QString          m_prefixErr;
     QString          m_prefixOk;
+    QObject         *m_requestScope;
+    int              m_savedFds[3];
     bool             m_selectableLabel;
+    int              m_serverFd;
+    QSocketNotifier *m_serverNotifier;
     QSize            m_size;
+    int              m_stdinBatchMs;
+    QByteArray       m_stdinBuffer;
+    QStringList      m_stdinCells;
+    bool             m_stdinClosed;
+    StdinFormat      m_stdinFormat;
+    QString          m_stdinText;
+    QTimer          *m_stdinTimer;
     QSystemTrayIcon *m_sysTray;
     bool             m_sysTrayMsg;
     int              m_timeout;
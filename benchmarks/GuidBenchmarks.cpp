@@ -0,0 +1,312 @@
+/*
+ * Benchmarks of the hot paths of guid.
+ *
+ * Copyright (C) 2021  Misaki F. <https://github.com/misa-ki/guid>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// The static functions and helper classes of guid are only visible from its own file.
+#include "Guid.cpp"
+
+#include <QTemporaryFile>
+#include <QtTest>
+
+#ifdef Q_OS_UNIX
+    #include <fcntl.h>
+#endif
+
+/******************************************************************************
+ * class GuidBenchmarks
+ ******************************************************************************/
+
+// Each benchmark runs on 1k, 100k and 1M rows of synthetic data, built outside of the
+// measured block. The dialogs are built by the Guid instance of main(), which is reset
+// between two of them the way a server is between two requests.
+class GuidBenchmarks : public QObject
+{
+    Q_OBJECT
+    
+public:
+    explicit GuidBenchmarks(Guid *guid) : m_guid(guid) {}
+    
+private slots:
+    void readLines_data() { addRowCounts(); }
+    void readLines() {
+        QFETCH(int, rows);
+        QByteArray buffer;
+        for (int i = 0; i < rows; ++i)
+            buffer += "row " + QByteArray::number(i) + " of the list\n";
+        QBENCHMARK {
+            QStringList records;
+            readStdInRecords(buffer, Guid::Lines, true, records);
+        }
+    }
+    
+    void readLengthPrefixed_data() { addRowCounts(); }
+    void readLengthPrefixed() {
+        QFETCH(int, rows);
+        QByteArray buffer;
+        for (int i = 0; i < rows; ++i) {
+            const QByteArray record = "row " + QByteArray::number(i) + " of the list";
+            QByteArray length(4, '\0');
+            qToBigEndian<quint32>(record.size(), length.data());
+            buffer += length + record;
+        }
+        QBENCHMARK {
+            QStringList records;
+            readStdInRecords(buffer, Guid::LengthPrefixed, true, records);
+        }
+    }
+    
+    void listValuesFromFile_data() { addRowCounts(); }
+    void listValuesFromFile() {
+        QFETCH(int, rows);
+        QTemporaryFile file;
+        QVERIFY(file.open());
+        for (int i = 0; i < rows; ++i)
+            file.write("value " + QByteArray::number(i) + '\n');
+        file.close();
+        QBENCHMARK {
+            GList list = ::listValuesFromFile(file.fileName());
+        }
+    }
+    
+    // --text-info reading its content on stdin, batch after batch.
+    void readTextInfo_data() { addRowCounts(); }
+    void readTextInfo() {
+        #ifdef Q_OS_UNIX
+            QFETCH(int, rows);
+            QTemporaryFile file;
+            QVERIFY(file.open());
+            for (int i = 0; i < rows; ++i)
+                file.write("line " + QByteArray::number(i) + " of the text\n");
+            file.flush();
+            const qint64 size = file.size();
+            const int savedStdin = ::dup(STDIN_FILENO);
+            ::dup2(file.handle(), STDIN_FILENO);
+            QBENCHMARK {
+                newRequest();
+                ::lseek(STDIN_FILENO, 0, SEEK_SET);
+                m_guid->m_type = Guid::TextInfo;
+                m_guid->showText(QStringList() << "--text-info");
+                while (::lseek(STDIN_FILENO, 0, SEEK_CUR) < size) {
+                    m_guid->readStdIn();
+                    m_guid->processStdIn();
+                }
+            }
+            newRequest();
+            ::dup2(savedStdin, STDIN_FILENO);
+            ::close(savedStdin);
+        #else
+            QSKIP("stdin is redirected with POSIX calls");
+        #endif
+    }
+    
+    void addListItems_data() { addRowCounts(); }
+    void addListItems() {
+        QFETCH(int, rows);
+        const QStringList values = listValues(rows);
+        QBENCHMARK {
+            QTreeView list;
+            ListModel *model = new ListModel(2, &list);
+            list.setModel(model);
+            setUniformRowHeights(&list, model);
+            QStringList items = values;
+            addItems(&list, items);
+        }
+    }
+    
+    // A whole --forms dialog with a list, from its arguments to the dialog on screen.
+    void showFormsList_data() { addRowCounts(); }
+    void showFormsList() {
+        QFETCH(int, rows);
+        const QStringList args = formsListArgs(rows);
+        QBENCHMARK {
+            newRequest();
+            m_guid->m_type = Guid::Forms;
+            m_guid->showForms(args);
+        }
+        newRequest();
+    }
+    
+    void printForms_data() { addRowCounts(); }
+    void printForms() {
+        #ifdef Q_OS_UNIX
+            QFETCH(int, rows);
+            newRequest();
+            m_guid->m_type = Guid::Forms;
+            m_guid->showForms(formsListArgs(rows));
+            // QtTest prints its results once the function is done.
+            fflush(stdout);
+            const int savedStdout = ::dup(STDOUT_FILENO);
+            const int null = ::open("/dev/null", O_WRONLY);
+            ::dup2(null, STDOUT_FILENO);
+            ::close(null);
+            QBENCHMARK {
+                m_guid->printForms();
+            }
+            fflush(stdout);
+            ::dup2(savedStdout, STDOUT_FILENO);
+            ::close(savedStdout);
+            newRequest();
+        #else
+            QSKIP("stdout is redirected with POSIX calls");
+        #endif
+    }
+    
+    // A --add-text label filled with the default values of its markers.
+    void setMarkerText_data() { addRowCounts(); }
+    void setMarkerText() {
+        QFETCH(int, rows);
+        QString textTemplate;
+        for (int i = 0; i < rows; ++i)
+            textTemplate += QString("line %1: GUID_MARKER_%2\n").arg(i).arg(i % 9 + 1);
+        QLabel label;
+        label.setProperty("guid_text_content", textTemplate);
+        for (int i = 0; i < 9; ++i) {
+            label.setProperty(gs_markerFileProps[i], "");
+            label.setProperty(gs_markerVarNameProps[i], "");
+            label.setProperty(gs_defMarkerValProps[i], QString("value %1").arg(i + 1));
+        }
+        QBENCHMARK {
+            label.setProperty("guid_text_segments", QVariant());
+            label.setProperty("guid_text_markers_set", false);
+            label.setProperty("guid_text_marker_values", QVariant());
+            setText(&label);
+        }
+    }
+    
+    void parseFormsArguments_data() { addRowCounts(); }
+    void parseFormsArguments() {
+        QFETCH(int, rows);
+        QStringList argList;
+        argList << "guid" << "--forms" << "--lazy-tabs";
+        for (int i = 0; i < rows; ++i) {
+            if (i % 100 == 0)
+                argList << QString("--tab=Tab %1").arg(i / 100);
+            argList << QString("--add-entry=Field %1@placeholder=value").arg(i);
+        }
+        QBENCHMARK {
+            QHash<int, QStringList> pages;
+            const QStringList args = deferTabPages(splitOptions(argList, 1), pages);
+            WidgetSettings ws;
+            foreach (const QString &arg, args) {
+                if (!arg.startsWith("--"))
+                    readWidgetSettings(arg, ws);
+            }
+        }
+    }
+    
+    void encodeQRCode_data() {
+        QTest::addColumn<int>("length");
+        QTest::newRow("16") << 16;
+        QTest::newRow("256") << 256;
+        QTest::newRow("2048") << 2048;
+    }
+    void encodeQRCode() {
+        QFETCH(int, length);
+        const QByteArray text(length, 'a');
+        QBENCHMARK {
+            qrcodegen::QrCode::encodeText(text.constData(), qrcodegen::QrCode::Ecc::LOW);
+        }
+    }
+    
+    // --add-qr-code, the cache of rasterized codes left out.
+    void createQRCode_data() { encodeQRCode_data(); }
+    void createQRCode() {
+        QFETCH(int, length);
+        const QString text(length, 'a');
+        QLabel label;
+        QBENCHMARK {
+            gs_qrCodeImages.clear();
+            m_guid->createQRCode(&label, text);
+        }
+    }
+    
+private:
+    static void addRowCounts() {
+        QTest::addColumn<int>("rows");
+        QTest::newRow("1k") << 1000;
+        QTest::newRow("100k") << 100000;
+        QTest::newRow("1M") << 1000000;
+    }
+    
+    // Two columns, given row after row.
+    static QStringList listValues(int rows) {
+        QStringList values;
+        values.reserve(2 * rows);
+        for (int i = 0; i < rows; ++i)
+            values << QString("item %1").arg(i) << QString::number(rows - i);
+        return values;
+    }
+    
+    // Canonical arguments of a form holding an entry and a two-column list printed whole.
+    static QStringList formsListArgs(int rows) {
+        return QStringList() << "--forms" << "--add-entry" << "Name" << "--add-list" << "Items"
+                             << "--column-values" << "Item|Count" << "--list-values"
+                             << listValues(rows).join('|') << "--print-values" << "all"
+                             << "--print-column" << "all";
+    }
+    
+    // What Guid::finishRequest() does once a client is answered, without the client.
+    void newRequest() {
+        if (m_guid->m_dialog) {
+            m_guid->m_dialog->disconnect(m_guid);
+            delete m_guid->m_dialog;
+        }
+        if (gs_stdin) {
+            gs_stdin->disconnect();
+            gs_stdin->close();
+            delete gs_stdin;
+            gs_stdin = NULL;
+        }
+        delete m_guid->m_stdinTimer;
+        delete m_guid->m_requestScope;
+        gs_fileWidgets.clear();
+        gs_markerFiles.clear();
+        gs_typeWidgets.clear();
+        gs_widgetFiles.clear();
+        m_guid->resetState();
+        m_guid->m_requestScope = new QObject(m_guid);
+    }
+    
+    Guid *m_guid;
+};
+
+// End of "class GuidBenchmarks"
+
+/******************************************************************************
+ * main
+ ******************************************************************************/
+
+int main(int argc, char **argv)
+{
+    // The benchmarks don't need a display, CI machines don't have one.
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    // Guid is the application and starts on a dialog, an empty form is the lightest one.
+    // The arguments of QtTest are left to QTest::qExec().
+    char name[] = "guid";
+    char forms[] = "--forms";
+    char *guidArgv[] = { name, forms, NULL };
+    int guidArgc = 2;
+    Guid guid(guidArgc, guidArgv);
+    GuidBenchmarks benchmarks(&guid);
+    return QTest::qExec(&benchmarks, argc, argv);
+}
+
+// End of "main"
+
+#include "GuidBenchmarks.moc"
+
+// vim:set et sw=4 ts=4
@@ -0,0 +1,22 @@
+# QtTest benchmarks of the hot paths of guid, on synthetic data of 1k, 100k and 1M rows.
+# They run offscreen. "make check" runs them and compares the results to baseline.csv,
+# which "make baseline" records; as timings only compare on the same machine, CI records
+# it once and commits it. The usual QtTest options also work, e.g.:
+#   qmake benchmarks/benchmarks.pro && make && ./guid-benchmarks -o results.xml,xml
+HEADERS = ../Guid.h ../qrcodegen/qrcodegen.hpp
+SOURCES = GuidBenchmarks.cpp ../qrcodegen/qrcodegen.cpp
+RESOURCES = ../guid.qrc
+INCLUDEPATH += ..
+DEFINES += GUID_NO_MAIN
+QT += concurrent dbus gui network testlib widgets
+unix:!macx:QT += x11extras
+TARGET = guid-benchmarks
+CONFIG += console
+macx:CONFIG -= app_bundle
+
+unix:!macx:LIBS += -lX11
+unix:!macx:DEFINES += WS_X11
+
+check.commands = ./$$TARGET -o results.csv,csv && sh $$PWD/compare-baseline.sh $$PWD/baseline.csv results.csv
+baseline.commands = ./$$TARGET -o $$PWD/baseline.csv,csv
+QMAKE_EXTRA_TARGETS += check baseline
@@ -0,0 +1,30 @@
+#!/bin/sh
+# Compares the results of guid-benchmarks, written with "-o FILE,csv", to a baseline
+# recorded the same way on the same machine. A benchmark slower than its baseline by more
+# than BENCHMARK_TOLERANCE percent (25 by default) fails the comparison, benchmarks the
+# baseline doesn't know yet are only listed.
+#   compare-baseline.sh baseline.csv results.csv
+
+if [ $# -ne 2 ]; then
+    echo "usage: $0 BASELINE.csv RESULTS.csv" >&2
+    exit 2
+fi
+if [ ! -f "$1" ]; then
+    echo "$0: no baseline in $1, record one with \"make baseline\" on this machine" >&2
+    exit 2
+fi
+
+awk -F, -v tolerance="${BENCHMARK_TOLERANCE:-25}" '
+    # "function","tag","metric",value per iteration,total,iterations
+    !/^"/ { next }
+    { key = $1 " " $2 " " $3 }
+    FNR == NR { base[key] = $4; next }
+    !(key in base) { printf "new     %s %.4g\n", key, $4; next }
+    {
+        change = base[key] > 0 ? ($4 / base[key] - 1) * 100 : 0
+        slower = change > tolerance
+        failed = failed || slower
+        printf "%-7s %s %.4g -> %.4g (%+.1f%%)\n", slower ? "SLOWER" : "ok", key, base[key], $4, change
+    }
+    END { exit failed }
+' "$1" "$2"
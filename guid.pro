@@ -1,7 +1,7 @@
 HEADERS = Guid.h qrcodegen/qrcodegen.hpp
 SOURCES = Guid.cpp qrcodegen/qrcodegen.cpp
 RESOURCES = guid.qrc
-QT += dbus gui widgets
+QT += concurrent dbus gui network widgets
 unix:!macx:QT += x11extras
 TARGET = guid
 
@@ -22,18 +22,22 @@
  */
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <climits>
 #include <cstddef>
 #include <cstdlib>
 #include <cstring>
 #include <sstream>
+#include <system_error>
+#include <thread>
 #include <utility>
 #include "qrcodegen.hpp"
 
 using std::int8_t;
 using std::uint8_t;
 using std::size_t;
+using std::uint64_t;
 using std::vector;
 
 
@@ -326,9 +330,10 @@ QrCode::QrCode(int ver, Ecc ecl, const vector<uint8_t> &dataCodewords, int msk)
 	if (msk < -1 || msk > 7)
 		throw std::domain_error("Mask value out of range");
 	size = ver * 4 + 17;
-	size_t sz = static_cast<size_t>(size);
-	modules    = vector<vector<bool> >(sz, vector<bool>(sz));  // Initially all light
-	isFunction = vector<vector<bool> >(sz, vector<bool>(sz));
+	rowWords = (size + 63) / 64;
+	size_t sz = static_cast<size_t>(size * rowWords);
+	modules    = vector<uint64_t>(sz);  // Initially all light
+	isFunction = vector<uint64_t>(sz);
 	
 	// Compute ECC, draw modules
 	drawFunctionPatterns();
@@ -337,22 +342,44 @@ QrCode::QrCode(int ver, Ecc ecl, const vector<uint8_t> &dataCodewords, int msk)
 	
 	// Do masking
 	if (msk == -1) {  // Automatically choose best mask
+		// Each candidate is scored on its own copy of the grid, so the masks are shared
+		// between worker threads. The calling thread scores whatever is left.
+		std::array<long,8> penalties;
+		std::atomic<int> nextMask(0);
+		auto scoreMasks = [&]() {
+			for (int i = nextMask++; i < 8; i = nextMask++) {
+				vector<uint64_t> candidate = modules;
+				applyMask(i, candidate);
+				drawFormatBits(i, candidate);
+				penalties.at(static_cast<size_t>(i)) = getPenaltyScore(candidate);
+			}
+		};
+		unsigned int numThreads = std::min(std::thread::hardware_concurrency(), 8U);
+		vector<std::thread> workers;
+		for (unsigned int i = 1; i < numThreads; i++) {
+			try {
+				workers.emplace_back(scoreMasks);
+			} catch (const std::system_error &) {
+				break;
+			}
+		}
+		scoreMasks();
+		for (std::thread &worker : workers)
+			worker.join();
+		
 		long minPenalty = LONG_MAX;
 		for (int i = 0; i < 8; i++) {
-			applyMask(i);
-			drawFormatBits(i);
-			long penalty = getPenaltyScore();
+			long penalty = penalties.at(static_cast<size_t>(i));
 			if (penalty < minPenalty) {
 				msk = i;
 				minPenalty = penalty;
 			}
-			applyMask(i);  // Undoes the mask due to XOR
 		}
 	}
 	assert(0 <= msk && msk <= 7);
 	mask = msk;
-	applyMask(msk);  // Apply the final choice of mask
-	drawFormatBits(msk);  // Overwrite old format bits
+	applyMask(msk, modules);  // Apply the final choice of mask
+	drawFormatBits(msk, modules);  // Overwrite old format bits
 	
 	isFunction.clear();
 	isFunction.shrink_to_fit();
@@ -407,13 +434,22 @@ void QrCode::drawFunctionPatterns() {
 		}
 	}
 	
-	// Draw configuration data
-	drawFormatBits(0);  // Dummy mask value; overwritten later in the constructor
+	// Draw configuration data, marking the format modules as
+	// function modules since drawFormatBits() only sets colors
+	drawFormatBits(0, modules);  // Dummy mask value; overwritten later in the constructor
+	for (int i = 0; i < 9; i++) {
+		setFunctionModule(8, i, module(8, i));
+		setFunctionModule(i, 8, module(i, 8));
+	}
+	for (int i = 0; i < 8; i++) {
+		setFunctionModule(size - 1 - i, 8, module(size - 1 - i, 8));
+		setFunctionModule(8, size - 1 - i, module(8, size - 1 - i));
+	}
 	drawVersion();
 }
 
 
-void QrCode::drawFormatBits(int msk) {
+void QrCode::drawFormatBits(int msk, vector<uint64_t> &grid) const {
 	// Calculate error correction code and pack bits
 	int data = getFormatBits(errorCorrectionLevel) << 3 | msk;  // errCorrLvl is uint2, msk is uint3
 	int rem = data;
@@ -424,19 +460,19 @@ void QrCode::drawFormatBits(int msk) {
 	
 	// Draw first copy
 	for (int i = 0; i <= 5; i++)
-		setFunctionModule(8, i, getBit(bits, i));
-	setFunctionModule(8, 7, getBit(bits, 6));
-	setFunctionModule(8, 8, getBit(bits, 7));
-	setFunctionModule(7, 8, getBit(bits, 8));
+		setModule(grid, 8, i, getBit(bits, i));
+	setModule(grid, 8, 7, getBit(bits, 6));
+	setModule(grid, 8, 8, getBit(bits, 7));
+	setModule(grid, 7, 8, getBit(bits, 8));
 	for (int i = 9; i < 15; i++)
-		setFunctionModule(14 - i, 8, getBit(bits, i));
+		setModule(grid, 14 - i, 8, getBit(bits, i));
 	
 	// Draw second copy
 	for (int i = 0; i < 8; i++)
-		setFunctionModule(size - 1 - i, 8, getBit(bits, i));
+		setModule(grid, size - 1 - i, 8, getBit(bits, i));
 	for (int i = 8; i < 15; i++)
-		setFunctionModule(8, size - 15 + i, getBit(bits, i));
-	setFunctionModule(8, size - 8, true);  // Always dark
+		setModule(grid, 8, size - 15 + i, getBit(bits, i));
+	setModule(grid, 8, size - 8, true);  // Always dark
 }
 
 
@@ -483,15 +519,22 @@ void QrCode::drawAlignmentPattern(int x, int y) {
 
 
 void QrCode::setFunctionModule(int x, int y, bool isDark) {
-	size_t ux = static_cast<size_t>(x);
-	size_t uy = static_cast<size_t>(y);
-	modules   .at(uy).at(ux) = isDark;
-	isFunction.at(uy).at(ux) = true;
+	setModule(modules, x, y, isDark);
+	setModule(isFunction, x, y, true);
 }
 
 
 bool QrCode::module(int x, int y) const {
-	return modules.at(static_cast<size_t>(y)).at(static_cast<size_t>(x));
+	assert(0 <= x && x < size && 0 <= y && y < size);
+	return ((modules.at(static_cast<size_t>(y * rowWords + x / 64)) >> (x % 64)) & 1) != 0;
+}
+
+
+void QrCode::setModule(vector<uint64_t> &grid, int x, int y, bool isDark) const {
+	assert(0 <= x && x < size && 0 <= y && y < size);
+	uint64_t &word = grid.at(static_cast<size_t>(y * rowWords + x / 64));
+	uint64_t bit = static_cast<uint64_t>(1) << (x % 64);
+	word = isDark ? (word | bit) : (word & ~bit);
 }
 
 
@@ -544,11 +587,12 @@ void QrCode::drawCodewords(const vector<uint8_t> &data) {
 			right = 5;
 		for (int vert = 0; vert < size; vert++) {  // Vertical counter
 			for (int j = 0; j < 2; j++) {
-				size_t x = static_cast<size_t>(right - j);  // Actual x coordinate
+				int x = right - j;  // Actual x coordinate
 				bool upward = ((right + 1) & 2) == 0;
-				size_t y = static_cast<size_t>(upward ? size - 1 - vert : vert);  // Actual y coordinate
-				if (!isFunction.at(y).at(x) && i < data.size() * 8) {
-					modules.at(y).at(x) = getBit(data.at(i >> 3), 7 - static_cast<int>(i & 7));
+				int y = upward ? size - 1 - vert : vert;  // Actual y coordinate
+				bool function = ((isFunction.at(static_cast<size_t>(y * rowWords + x / 64)) >> (x % 64)) & 1) != 0;
+				if (!function && i < data.size() * 8) {
+					setModule(modules, x, y, getBit(data.at(i >> 3), 7 - static_cast<int>(i & 7)));
 					i++;
 				}
 				// If this QR Code has any remainder bits (0 to 7), they were assigned as
@@ -560,12 +604,13 @@ void QrCode::drawCodewords(const vector<uint8_t> &data) {
 }
 
 
-void QrCode::applyMask(int msk) {
+void QrCode::applyMask(int msk, vector<uint64_t> &grid) const {
 	if (msk < 0 || msk > 7)
 		throw std::domain_error("Mask value out of range");
-	size_t sz = static_cast<size_t>(size);
-	for (size_t y = 0; y < sz; y++) {
-		for (size_t x = 0; x < sz; x++) {
+	// Every mask pattern repeats itself every 12 rows, so only the first rows are computed
+	std::array<std::array<uint64_t,3>,12> patterns = {};
+	for (size_t y = 0; y < 12 && y < static_cast<size_t>(size); y++) {
+		for (size_t x = 0; x < static_cast<size_t>(size); x++) {
 			bool invert;
 			switch (msk) {
 				case 0:  invert = (x + y) % 2 == 0;                    break;
@@ -578,79 +623,57 @@ void QrCode::applyMask(int msk) {
 				case 7:  invert = ((x + y) % 2 + x * y % 3) % 2 == 0;  break;
 				default:  throw std::logic_error("Unreachable");
 			}
-			modules.at(y).at(x) = modules.at(y).at(x) ^ (invert & !isFunction.at(y).at(x));
+			patterns.at(y).at(x / 64) |= static_cast<uint64_t>(invert) << (x % 64);
+		}
+	}
+	for (int y = 0; y < size; y++) {
+		for (int w = 0; w < rowWords; w++) {
+			size_t i = static_cast<size_t>(y * rowWords + w);
+			grid.at(i) ^= patterns.at(static_cast<size_t>(y % 12)).at(static_cast<size_t>(w)) & ~isFunction.at(i);
 		}
 	}
 }
 
 
-long QrCode::getPenaltyScore() const {
+long QrCode::getPenaltyScore(const vector<uint64_t> &grid) const {
 	long result = 0;
+	size_t rw = static_cast<size_t>(rowWords);
 	
 	// Adjacent modules in row having same color, and finder-like patterns
-	for (int y = 0; y < size; y++) {
-		bool runColor = false;
-		int runX = 0;
-		std::array<int,7> runHistory = {};
-		for (int x = 0; x < size; x++) {
-			if (module(x, y) == runColor) {
-				runX++;
-				if (runX == 5)
-					result += PENALTY_N1;
-				else if (runX > 5)
-					result++;
-			} else {
-				finderPenaltyAddHistory(runX, runHistory);
-				if (!runColor)
-					result += finderPenaltyCountPatterns(runHistory) * PENALTY_N3;
-				runColor = module(x, y);
-				runX = 1;
-			}
-		}
-		result += finderPenaltyTerminateAndCount(runColor, runX, runHistory) * PENALTY_N3;
-	}
-	// Adjacent modules in column having same color, and finder-like patterns
-	for (int x = 0; x < size; x++) {
-		bool runColor = false;
-		int runY = 0;
-		std::array<int,7> runHistory = {};
-		for (int y = 0; y < size; y++) {
-			if (module(x, y) == runColor) {
-				runY++;
-				if (runY == 5)
-					result += PENALTY_N1;
-				else if (runY > 5)
-					result++;
-			} else {
-				finderPenaltyAddHistory(runY, runHistory);
-				if (!runColor)
-					result += finderPenaltyCountPatterns(runHistory) * PENALTY_N3;
-				runColor = module(x, y);
-				runY = 1;
+	for (size_t y = 0; y < static_cast<size_t>(size); y++)
+		result += getLinePenaltyScore(&grid.at(y * rw));
+	
+	// Adjacent modules in column having same color, and finder-like patterns,
+	// scanned as the rows of the transposed grid
+	vector<uint64_t> columns(grid.size());
+	for (size_t y = 0; y < static_cast<size_t>(size); y++) {
+		for (size_t w = 0; w < rw; w++) {
+			for (uint64_t bits = grid.at(y * rw + w); bits != 0; bits &= bits - 1) {
+				size_t x = w * 64 + static_cast<size_t>(lowestBit(bits));
+				columns.at(x * rw + y / 64) |= static_cast<uint64_t>(1) << (y % 64);
 			}
 		}
-		result += finderPenaltyTerminateAndCount(runColor, runY, runHistory) * PENALTY_N3;
 	}
+	for (size_t x = 0; x < static_cast<size_t>(size); x++)
+		result += getLinePenaltyScore(&columns.at(x * rw));
 	
-	// 2*2 blocks of modules having same color
-	for (int y = 0; y < size - 1; y++) {
-		for (int x = 0; x < size - 1; x++) {
-			bool  color = module(x, y);
-			if (  color == module(x + 1, y) &&
-			      color == module(x, y + 1) &&
-			      color == module(x + 1, y + 1))
-				result += PENALTY_N2;
+	// 2*2 blocks of modules having same color: a module starts a block when it matches
+	// the module below it and both match their right neighbor
+	for (size_t y = 0; y + 1 < static_cast<size_t>(size); y++) {
+		const uint64_t *top = &grid.at(y * rw);
+		const uint64_t *bottom = &grid.at((y + 1) * rw);
+		for (size_t w = 0; w < rw; w++) {
+			uint64_t topRight = top[w] >> 1 | (w + 1 < rw ? top[w + 1] << 63 : 0);
+			uint64_t bottomRight = bottom[w] >> 1 | (w + 1 < rw ? bottom[w + 1] << 63 : 0);
+			uint64_t same = ~(top[w] ^ bottom[w]) & ~(top[w] ^ topRight) & ~(bottom[w] ^ bottomRight);
+			result += bitCount(same & lineMask(static_cast<int>(w), size - 1)) * PENALTY_N2;
 		}
 	}
 	
 	// Balance of dark and light modules
 	int dark = 0;
-	for (const vector<bool> &row : modules) {
-		for (bool color : row) {
-			if (color)
-				dark++;
-		}
-	}
+	for (uint64_t word : grid)
+		dark += bitCount(word);
 	int total = size * size;  // Note that size is odd, so dark/total != 1/2
 	// Compute the smallest integer k >= 0 such that (45-5k)% <= dark/total <= (55+5k)%
 	int k = static_cast<int>((std::abs(dark * 20L - total * 10L) + total - 1) / total) - 1;
@@ -661,6 +684,36 @@ long QrCode::getPenaltyScore() const {
 }
 
 
+long QrCode::getLinePenaltyScore(const uint64_t *line) const {
+	long result = 0;
+	bool runColor = false;
+	int runStart = 0;
+	std::array<int,7> runHistory = {};
+	uint64_t previous = 0;  // The module before the line is light
+	for (int w = 0; w < rowWords; w++) {
+		// Each set bit marks a module whose color differs from the one before it, i.e. the end of a run
+		uint64_t changes = (line[w] ^ (line[w] << 1 | previous)) & lineMask(w, size);
+		previous = line[w] >> 63;
+		for (; changes != 0; changes &= changes - 1) {
+			int runEnd = w * 64 + lowestBit(changes);
+			int runLength = runEnd - runStart;
+			if (runLength >= 5)
+				result += PENALTY_N1 + runLength - 5;
+			finderPenaltyAddHistory(runLength, runHistory);
+			if (!runColor)
+				result += finderPenaltyCountPatterns(runHistory) * PENALTY_N3;
+			runColor = !runColor;
+			runStart = runEnd;
+		}
+	}
+	int runLength = size - runStart;
+	if (runLength >= 5)
+		result += PENALTY_N1 + runLength - 5;
+	result += finderPenaltyTerminateAndCount(runColor, runLength, runHistory) * PENALTY_N3;
+	return result;
+}
+
+
 vector<int> QrCode::getAlignmentPatternPositions() const {
 	if (version == 1)
 		return vector<int>();
@@ -782,6 +835,38 @@ bool QrCode::getBit(long x, int i) {
 }
 
 
+int QrCode::bitCount(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+	return __builtin_popcountll(x);
+#else
+	x = x - ((x >> 1) & 0x5555555555555555ULL);
+	x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+	x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+	return static_cast<int>((x * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+
+int QrCode::lowestBit(uint64_t x) {
+	assert(x != 0);
+#if defined(__GNUC__) || defined(__clang__)
+	return __builtin_ctzll(x);
+#else
+	return bitCount((x & (~x + 1)) - 1);
+#endif
+}
+
+
+uint64_t QrCode::lineMask(int w, int limit) {
+	int bits = limit - w * 64;
+	if (bits <= 0)
+		return 0;
+	if (bits >= 64)
+		return ~static_cast<uint64_t>(0);
+	return (static_cast<uint64_t>(1) << bits) - 1;
+}
+
+
 /*---- Tables of constants ----*/
 
 const int QrCode::PENALTY_N1 =  3;
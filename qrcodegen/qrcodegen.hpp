@@ -312,14 +312,18 @@ class QrCode final {
 	 * the resulting object still has a mask value between 0 and 7. */
 	private: int mask;
 	
-	// Private grids of modules/pixels, with dimensions of size*size:
+	// Private grids of modules/pixels, with dimensions of size*size. Each row is packed into
+	// rowWords 64-bit words, bit x%64 of word x/64 holding column x; padding bits are always 0.
 	
-	// The modules of this QR Code (false = light, true = dark).
+	/* The number of 64-bit words per grid row, which is between 1 and 3 (inclusive). */
+	private: int rowWords;
+	
+	// The modules of this QR Code (0 = light, 1 = dark).
 	// Immutable after constructor finishes. Accessed through getModule().
-	private: std::vector<std::vector<bool> > modules;
+	private: std::vector<std::uint64_t> modules;
 	
 	// Indicates function modules that are not subjected to masking. Discarded when constructor finishes.
-	private: std::vector<std::vector<bool> > isFunction;
+	private: std::vector<std::uint64_t> isFunction;
 	
 	
 	
@@ -376,9 +380,9 @@ class QrCode final {
 	private: void drawFunctionPatterns();
 	
 	
-	// Draws two copies of the format bits (with its own error correction code)
+	// Draws two copies of the format bits (with its own error correction code) into the given grid,
 	// based on the given mask and this object's error correction level field.
-	private: void drawFormatBits(int msk);
+	private: void drawFormatBits(int msk, std::vector<std::uint64_t> &grid) const;
 	
 	
 	// Draws two copies of the version bits (with its own error correction code),
@@ -405,6 +409,10 @@ class QrCode final {
 	private: bool module(int x, int y) const;
 	
 	
+	// Sets the color of a module in the given grid. Coordinates must be in range.
+	private: void setModule(std::vector<std::uint64_t> &grid, int x, int y, bool isDark) const;
+	
+	
 	/*---- Private helper methods for constructor: Codewords and masking ----*/
 	
 	// Returns a new byte string representing the given data with the appropriate error correction
@@ -422,12 +430,18 @@ class QrCode final {
 	// before masking. Due to the arithmetic of XOR, calling applyMask() with
 	// the same mask value a second time will undo the mask. A final well-formed
 	// QR Code needs exactly one (not zero, two, etc.) mask applied.
-	private: void applyMask(int msk);
+	private: void applyMask(int msk, std::vector<std::uint64_t> &grid) const;
 	
 	
-	// Calculates and returns the penalty score based on state of this QR Code's current modules.
+	// Calculates and returns the penalty score of the given grid of modules.
 	// This is used by the automatic mask choice algorithm to find the mask pattern that yields the lowest score.
-	private: long getPenaltyScore() const;
+	// Candidate grids don't share state, so all masks can be scored concurrently.
+	private: long getPenaltyScore(const std::vector<std::uint64_t> &grid) const;
+	
+	
+	// Returns the run length and finder-like pattern penalties of one packed line of modules.
+	// A helper function for getPenaltyScore().
+	private: long getLinePenaltyScore(const std::uint64_t *line) const;
 	
 	
 	
@@ -482,6 +496,18 @@ class QrCode final {
 	private: static bool getBit(long x, int i);
 	
 	
+	// Returns the number of bits set to 1 in x.
+	private: static int bitCount(std::uint64_t x);
+	
+	
+	// Returns the index of the lowest bit set to 1 in x, which must not be 0.
+	private: static int lowestBit(std::uint64_t x);
+	
+	
+	// Returns the bits of the w'th word of a packed line that lie before column limit.
+	private: static std::uint64_t lineMask(int w, int limit);
+	
+	
 	/*---- Constants and tables ----*/
 	
 	// The minimum version number supported in the QR Code Model 2 standard.